@@ -34,6 +34,7 @@
 /* include ------------------------------------------------------------------ */
 #include "eos.h"
 #include <string.h>
+#include <stddef.h>
 
 EOS_TAG("EventOS")
 
@@ -56,12 +57,69 @@ enum
     EosEventGiveType_Publish,
 };
 
-/* Private define ----------------------------------------------------------- */
-#if ((EOS_MAX_TASKS % 8) == 0)
-#define EOS_MAX_OWNER                       (EOS_MAX_TASKS >> 3)
+#if (EOS_USE_TOPIC_TABLE != 0)
+/* The key known in the building time. The table and its seeds are generated
+   by tools/eos_topic_gen.py, and placed in the read-only memory. The key in
+   the table takes the object with the same index. */
+typedef struct eos_topic_key
+{
+    const char *key;
+    eos_u32_t hash;
+    eos_u16_t key_len;
+    eos_u8_t type;
+} eos_topic_key_t;
+
+#include "eos_topic_table.h"
+
+#if (EOS_TOPIC_TABLE_SIZE > EOS_MAX_OBJECTS)
+#error The topic table is larger than the object table !
+#endif
+
+/* The slot of the key in the topic table. The seed of the key's bucket is
+   searched by the generator, to make the slots of all the keys different. */
+static inline eos_u16_t eos_topic_table_slot_(eos_u32_t hash)
+{
+    eos_u32_t x = hash + eos_topic_seed[hash % EOS_TOPIC_SEED_SIZE] * 0x9e3779b1U;
+    x ^= (x >> 15);
+    x *= 0x85ebca6bU;
+    x ^= (x >> 13);
+
+    return (eos_u16_t)(x % EOS_TOPIC_TABLE_SIZE);
+}
 #else
-#define EOS_MAX_OWNER                       (EOS_MAX_TASKS >> 3 + 1)
+#define EOS_TOPIC_TABLE_SIZE                0
+#endif
+
+#if (EOS_USE_STATIC_REG != 0)
+/* The begin and the end of the static registry section. */
+#if defined(__ARMCC_VERSION)
+extern const int EosReg$$Base;
+extern const int EosReg$$Limit;
+#define EOS_REG_BEGIN                       ((const eos_reg_t *)&EosReg$$Base)
+#define EOS_REG_END                         ((const eos_reg_t *)&EosReg$$Limit)
+#elif defined(__IAR_SYSTEMS_ICC__)
+#pragma section="EosReg"
+#define EOS_REG_BEGIN                       ((const eos_reg_t *)__section_begin("EosReg"))
+#define EOS_REG_END                         ((const eos_reg_t *)__section_end("EosReg"))
+#elif defined(_WIN32) && defined(__GNUC__)
+/* The grouped sections are sorted by the name after '$' in the PE linker. */
+EOS_USED EOS_REG_ALIGN static const eos_reg_t eos_reg_begin
+    EOS_SECTION("EosReg$a") = { 0 };
+EOS_USED EOS_REG_ALIGN static const eos_reg_t eos_reg_end
+    EOS_SECTION("EosReg$z") = { 0 };
+#define EOS_REG_BEGIN                       (&eos_reg_begin + 1)
+#define EOS_REG_END                         (&eos_reg_end)
+#elif defined(__GNUC__)
+extern const eos_reg_t __start_EosReg[];
+extern const eos_reg_t __stop_EosReg[];
+#define EOS_REG_BEGIN                       (__start_EosReg)
+#define EOS_REG_END                         (__stop_EosReg)
 #endif
+#endif
+
+/* Private define ----------------------------------------------------------- */
+/* The owner bitmap is made of 32-bit words. */
+#define EOS_MAX_OWNER                       ((EOS_MAX_TASKS + 31) >> 5)
 
 #if ((EOS_MAX_OBJECTS % 8) == 0)
 #define EOS_MAX_TASK_OCCUPY                 (EOS_MAX_OBJECTS >> 3)
@@ -72,10 +130,10 @@ enum
 /* Timer atrribute ---------------------------------------------------------- */
 #define EOS_TIMER_ATTRIBUTE_SEND            ((eos_u8_t)0x01U)
 #define EOS_TIMER_ATTRIBUTE_PUBLISH         ((eos_u8_t)0x00U)
+#define EOS_TIMER_ATTRIBUTE_ONESHOT         ((eos_u8_t)0x02U)
 
 /* Event atrribute ---------------------------------------------------------- */
 #define EOS_EVENT_ATTRIBUTE_GLOBAL          ((eos_u8_t)0x80U)
-#define EOS_EVENT_ATTRIBUTE_UNBLOCKED       ((eos_u8_t)0x20U)
 #define EOS_EVENT_ATTRIBUTE_TOPIC           ((eos_u8_t)0x00U)
 #define EOS_EVENT_ATTRIBUTE_VALUE           EOS_DB_ATTRIBUTE_VALUE
 #define EOS_EVENT_ATTRIBUTE_STREAM          EOS_DB_ATTRIBUTE_STREAM
@@ -88,34 +146,110 @@ enum
 
 typedef struct eos_owner
 {
-    eos_u8_t data[EOS_MAX_OWNER];
+    eos_u32_t data[EOS_MAX_OWNER];
 } eos_owner_t;
 
+#if (EOS_USE_HEAP_TLSF != 0)
+/* The block of the TLSF heap. The previous physical block is always linked, so
+   the neighbours are merged in constant time. The free-list links are only
+   used by the free block, and they overlap with the user data. */
+typedef struct eos_heap_block
+{
+    struct eos_heap_block *prev_phys;
+    eos_u32_t size;                                     /* Bit 0 is free flag */
+    struct eos_heap_block *next_free;
+    struct eos_heap_block *prev_free;
+} eos_heap_block_t;
+
+#define EOS_HEAP_ALIGN                      (8U)
+#define EOS_HEAP_ALIGN_LOG2                 (3U)
+#define EOS_HEAP_FL_SHIFT                   (EOS_HEAP_SL_LOG2 + EOS_HEAP_ALIGN_LOG2)
+#define EOS_HEAP_SMALL                      (1U << EOS_HEAP_FL_SHIFT)
+#define EOS_HEAP_SIZE_LIMIT                                                    \
+    (1U << (EOS_HEAP_FL_COUNT + EOS_HEAP_FL_SHIFT - 1))
+#define EOS_HEAP_BLOCK_HEAD                                                    \
+    ((offsetof(eos_heap_block_t, next_free) + EOS_HEAP_ALIGN - 1) &            \
+        ~(EOS_HEAP_ALIGN - 1))
+#define EOS_HEAP_BLOCK_MIN                                                     \
+    ((sizeof(eos_heap_block_t) - EOS_HEAP_BLOCK_HEAD + EOS_HEAP_ALIGN - 1) &   \
+        ~(EOS_HEAP_ALIGN - 1))
+#else
 typedef struct eos_heap_block
 {
     struct eos_heap_block *next;
     eos_u32_t is_free                           : 1;
     eos_u32_t size                              : 31;
 } eos_heap_block_t;
-
-typedef struct eos_heap_tag
-{
-    eos_u8_t *data;
-    eos_heap_block_t *list;
-    eos_u32_t size                              : 24;
-    eos_u32_t error_id                          : 8;
-} eos_heap_t;
+#endif
 
 typedef struct eos_event_data
 {
-    struct eos_event_data *next;
-    struct eos_event_data *last;
     eos_owner_t e_owner;
+    void *buf;                                          /* Payload buffer */
+    eos_u32_t value;                                    /* Inline value */
     eos_u32_t time;
     eos_u16_t id;
     eos_u8_t type;
 } eos_event_data_t;
 
+/* The event record in the pool, which is linked in the free list when it is not
+   used. */
+typedef union eos_event_record
+{
+    eos_event_data_t data;
+    union eos_event_record *next;
+} eos_event_record_t;
+
+typedef struct eos_event_pool
+{
+    eos_event_record_t record[EOS_MAX_EVENT_RECORD];
+    eos_event_record_t *free;
+    eos_u16_t count_free;
+    eos_u16_t count_free_min;                           /* Low-water mark */
+    eos_u32_t count_exhausted;                          /* Failed allocation */
+} eos_event_pool_t;
+
+/* The mailbox of one task, a ring of the event data references. The event data
+   is shared by all its owners, and each owner holds one reference in its own
+   mailbox. The head and tail are free-running indexes. */
+typedef struct eos_mailbox
+{
+    eos_event_data_t *e_item[EOS_SIZE_MAILBOX];
+    eos_event_data_t *e_hold;                           /* Payload in reading */
+    eos_u16_t head;
+    eos_u16_t tail;
+} eos_mailbox_t;
+
+#if (EOS_SIZE_ISR_RING != 0)
+/* The event published in ISR, which is only recorded in the ring, and given by
+   the ISR task later. */
+typedef struct eos_isr_event
+{
+    eos_u32_t value;
+    eos_topic_t topic;
+} eos_isr_event_t;
+
+typedef struct eos_isr_ring
+{
+    eos_isr_event_t event[EOS_SIZE_ISR_RING];
+    volatile eos_u16_t head;                            /* Written by ISR */
+    volatile eos_u16_t tail;                            /* Written by task */
+    volatile bool signaled;
+    eos_u16_t count_used_max;                           /* High-water mark */
+    eos_u32_t count_overflow;
+    eos_sem_t sem;
+} eos_isr_ring_t;
+#endif
+
+#if (EOS_USE_EVENT_DATA != 0)
+/* The header of the payload buffer, which is put before the payload. */
+typedef union eos_event_buf
+{
+    eos_u32_t size;
+    eos_u64_t align;
+} eos_event_buf_t;
+#endif
+
 enum
 {
     Stream_OK                       = 0,
@@ -125,66 +259,205 @@ enum
     Stream_MemCovered               = -4,
 };
 
+/* The head and the tail run in the range of twice the capacity, so the full
+   stream and the empty one are told apart without any flag, and the size is
+   only one subtraction. The data is copied in two segments at most. The head
+   is only written by the producer, and the tail only by the consumer, so one
+   producer and one consumer work on it without any lock. */
 typedef struct eos_stream
 {
     void *data;
-    eos_u32_t head;
-    eos_u32_t tail;
-    bool empty;
+    volatile eos_u32_t head;                            /* [0, 2 * capacity) */
+    volatile eos_u32_t tail;                            /* [0, 2 * capacity) */
 
     eos_u32_t capacity;
+    eos_u32_t dropped;                                  /* Writes dropped */
+
+    eos_u32_t level_high;                               /* Readers woken */
+    eos_u32_t level_low;                                /* Writers woken */
+    eos_owner_t t_read;                                 /* Tasks for data */
+    eos_owner_t t_write;                                /* Tasks for space */
 } eos_stream_t;
 
-struct eos_object;
+/* The readers of the broadcast stream, placed between the stream head and the
+   stream data. The tail of the stream is the cursor of the slowest reader. */
+typedef struct eos_stream_reader
+{
+    eos_owner_t lagging;                                /* Readers losing data */
+    eos_u32_t cursor[EOS_MAX_TASKS];
+} eos_stream_reader_t;
+
+/* The tail of the value key, placed after the value. The dirty mask collects
+   the regions written since the last event of the key. The sequence counters
+   are only used by the lock-free value. The sequence is odd while any writer
+   is copying. Every writer takes a claim before copying, and copies again if
+   another writer claimed meanwhile, so the last writer finished leaves its
+   whole value. */
+typedef struct eos_db_tail
+{
+    eos_u32_t dirty;
+    volatile eos_u32_t seq;
+    volatile eos_u16_t nest;                            /* Writers copying */
+    volatile eos_u16_t claim;
+    eos_u32_t band;                                     /* Deadband, in bits */
+    eos_u32_t suppressed;                               /* Writes unchanged */
+    eos_u8_t band_type;
+} eos_db_tail_t;
+
+enum
+{
+    EosDbBand_None = 0,
+    EosDbBand_S32,
+    EosDbBand_F32,
+};
+
+#define EOS_DB_TAIL_OFFSET(size_)           (((size_) + 7) & ~7U)
 
-typedef union eos_obj_block
+/* The versions of the buffered value, placed after its tail, which is after
+   all the versions. Only the writer holding the reserved version changes the
+   current one, so the writers take turns. The version neither current nor read
+   is spare. */
+typedef struct eos_db_version
 {
-    struct
-    {
-        eos_event_data_t *e_item;
-        eos_owner_t e_sub;
-        eos_owner_t e_owner;                            /* The event owner */
-    } event;
-    struct
-    {
-        eos_task_handle_t tcb;
-    } task;
-    struct
-    {
-        eos_timer_t timer;
-        eos_task_handle_t target;
-    } timer;
-} eos_ocb_t;
+    volatile eos_u16_t readers[EOS_DB_VERSIONS];
+    volatile eos_u8_t current;
+    volatile eos_u8_t reserved;             /* EOS_DB_VERSIONS for no writer */
+} eos_db_version_t;
+
+#if (EOS_USE_DB_PERSIST != 0)
+/* The log of the persistent keys in the flash. Every sector starts with its
+   header, and the records follow it. The record header is programmed before
+   the value, so a record cut by a power loss still has its size, and is only
+   found by its CRC. The sequence of the sector grows by one for every new
+   head, so the newest sector is the head when mounting, and the oldest one is
+   always the next used sector after the head. */
+#define EOS_PERSIST_MAGIC_SECTOR            (0x53534F45U)       /* "EOSS" */
+#define EOS_PERSIST_MAGIC_RECORD            (0x52534F45U)       /* "EOSR" */
+#define EOS_PERSIST_ERASED                  (0xFFFFFFFFU)
+#define EOS_PERSIST_CHUNK                   (64)
+
+typedef struct eos_persist_sector
+{
+    eos_u32_t magic;
+    eos_u32_t seq;
+} eos_persist_sector_t;
 
+typedef struct eos_persist_record
+{
+    eos_u32_t magic;
+    eos_u32_t hash;                                     /* Hash of the key */
+    eos_u32_t size;
+    eos_u32_t crc;                                      /* Hash, size, value */
+} eos_persist_record_t;
+
+/* The index is built in mounting, and points to the newest record of every
+   key in the flash, registered or not. */
+typedef struct eos_persist_entry
+{
+    eos_u32_t hash;
+    eos_u32_t addr;
+} eos_persist_entry_t;
+
+typedef struct eos_persist
+{
+    const eos_flash_t *flash;
+    eos_u32_t seq;                                      /* Of the head */
+    eos_u32_t offset;                                   /* In the head */
+    eos_u16_t head;                                     /* Sector written */
+    eos_u16_t count;
+    eos_persist_entry_t entry[EOS_MAX_PERSIST_KEYS];
+    eos_u32_t save[(EOS_MAX_OBJECTS + 31) >> 5];        /* Keys to save */
+    eos_u32_t load[(EOS_MAX_OBJECTS + 31) >> 5];        /* Keys to load */
+    volatile bool signaled;
+    volatile bool flush;
+    volatile bool busy;
+    eos_sem_t sem;
+    eos_db_persist_info_t info;
+    eos_u32_t value[(EOS_SIZE_PERSIST_VALUE + 3) >> 2];
+} eos_persist_t;
+
+enum
+{
+    PersistWalk_Index = 0,                              /* Build the index */
+    PersistWalk_Find,                                   /* Find a good one */
+    PersistWalk_Collect,                                /* Move the live ones */
+    PersistWalk_Resume,                                 /* Collect after a cut */
+};
+#endif
+
+/* The object table is split into the hot part and the cold parts. The hash
+   lookup only touches the hot part, which is dense and small. The blocks of
+   every object type are in their own arrays. */
 typedef struct eos_object
 {
     const char *key;                                    /* Key */
-    eos_ocb_t ocb;                                      /* object block */
+    eos_u32_t hash;                                     /* Hash value of key */
+    eos_u16_t key_len;                                  /* Length of key */
+    eos_u16_t block;                                    /* Task or timer index */
     eos_u32_t type                   : 8;               /* Object type */
     eos_u32_t attribute              : 8;
     eos_u32_t size                   : 16;              /* Value size */
+} eos_object_t;
+
+/* The event block, in the same index with the object. */
+typedef struct eos_obj_event
+{
+    eos_event_data_t *e_item;
+    eos_owner_t e_sub;
     union
     {
         void *value;                                    /* for value-event */
         eos_stream_t *stream;                           /* for stream-event */
     } data;
-} eos_object_t;
+} eos_obj_event_t;
+
+#if (EOS_USE_TIME_EVENT != 0)
+/* The timer block, in the timer pool. */
+typedef struct eos_obj_timer
+{
+    eos_timer_t timer;
+    eos_task_handle_t target;
+    eos_u16_t e_id;                                     /* The event to give */
+    eos_u16_t id;                                       /* The timer object */
+} eos_obj_timer_t;
+#endif
 
 typedef struct eos_tag
 {
-    /* Hash table */
+    /* Object table, and the hash index of every object type */
     eos_object_t object[EOS_MAX_OBJECTS];
+    eos_u16_t index[EosObj_Max][EOS_MAX_OBJECTS];
     eos_u16_t prime_max;
+
+    /* The blocks of the objects */
+    eos_obj_event_t event[EOS_MAX_OBJECTS];
+#if (EOS_USE_TIME_EVENT != 0)
+    eos_obj_timer_t timer[EOS_MAX_TIMERS];
+#endif
+    eos_task_handle_t tcb[EOS_MAX_TASKS];
     
     eos_u16_t t_id[EOS_MAX_TASKS];
+    eos_owner_t t_recv_disable;             /* Tasks not receiving events */
 
-    /* Heap */
+    /* Event record pool */
+    eos_event_pool_t e_pool;
+#if (EOS_SIZE_ISR_RING != 0)
+    eos_isr_ring_t isr_ring;
+#endif
+#if (EOS_USE_DB_PERSIST != 0)
+    eos_persist_t persist;
+#endif
 #if (EOS_USE_EVENT_DATA != 0)
-    eos_heap_t heap;
-    eos_u8_t heap_data[EOS_SIZE_HEAP];
+    eos_heap_t buf_heap;
+    eos_u64_t buf_data[EOS_SIZE_EVENT_BUF / 8];
 #endif
+
+    /* Heap */
     eos_heap_t db;
-    eos_event_data_t *e_queue;
+
+    /* Mailbox of every task */
+    eos_mailbox_t mailbox[EOS_MAX_TASKS];
+    eos_u32_t count_mailbox_full;           /* Events dropped, full mailbox */
 } eos_t;
 
 eos_t eos;
@@ -209,11 +482,11 @@ enum eos_event_topic
 
 static const eos_event_t eos_event_table[Event_User] =
 {
-    {"Event_Null", 0, 0},
-    {"Event_Enter", 0, 0},
-    {"Event_Exit", 0, 0},
+    {"Event_Null", 0, 0, EOS_NULL, 0},
+    {"Event_Enter", 0, 0, EOS_NULL, 0},
+    {"Event_Exit", 0, 0, EOS_NULL, 0},
 #if (EOS_USE_HSM_MODE != 0)
-    {"Event_Init", 0, 0},
+    {"Event_Init", 0, 0, EOS_NULL, 0},
 #endif
 };
 #endif
@@ -225,28 +498,53 @@ static const eos_event_t eos_event_table[Event_User] =
 #endif
 
 /* private hash function ---------------------------------------------------- */
+static char ch_type[EosObj_Max] = { 'A', 'E', 'T' };
+
 static eos_u32_t eos_hash_time33(char ch_type, const char *string);
+static eos_u32_t eos_hash_time33_len(char ch_type, const char *string,
+                                        eos_u16_t *length);
+static eos_u16_t eos_hash_find_(eos_u8_t obj_type, eos_u32_t hash,
+                                const char *string, eos_u16_t length);
 static eos_u16_t eos_hash_insert(eos_u8_t obj_type, const char *string);
+static void eos_hash_remove(eos_u8_t obj_type, eos_u16_t id);
+static inline eos_u16_t eos_hash_distance_(eos_u16_t slot, eos_u16_t id);
 static eos_u16_t eos_hash_get_index(eos_u8_t obj_type, const char *string);
-static bool eos_hash_existed(eos_u8_t obj_type, const char *string);
+static eos_u16_t eos_hash_get_index_hashed(eos_u8_t obj_type, eos_u32_t hash,
+                                           const char *string);
 
 /* private event functions -------------------------------------------------- */
 static eos_s8_t eos_event_give_(const char *task,
                                 eos_u32_t task_id,
                                 eos_u8_t give_type,
-                                const char *topic);
-static void eos_e_queue_delete_(eos_event_data_t const *item);
-static inline void eos_event_sub_(eos_task_handle_t const me, const char *topic);
+                                const char *topic,
+                                eos_topic_t topic_id,
+                                void *buf, eos_u32_t value);
+static void eos_e_item_release_(eos_event_data_t *e_item, eos_u16_t t_index);
+static void eos_e_item_hold_(eos_event_data_t *e_item, eos_u16_t t_index);
+static void eos_e_item_unhold_(eos_u16_t t_index);
+#if (EOS_USE_EVENT_DATA != 0)
+static void eos_event_buf_free_(void *buf);
+#endif
+static void eos_e_item_out_(eos_event_data_t const *e_item,
+                            eos_event_t * const e_out);
+static inline void eos_event_sub_(eos_task_handle_t const me, eos_topic_t e_id);
+static inline eos_task_handle_t eos_obj_task_(eos_u16_t t_id);
+static eos_err_t eos_db_register_(const char *key, eos_u32_t size,
+                                  eos_u8_t attribute, void *memory);
+#if (EOS_USE_STATIC_REG != 0)
+static void eos_reg_init(void);
+#endif
 
 /* private actor functions -------------------------------------------------- */
 static void eos_reactor_enter(eos_reactor_t *const me);
 static void eos_sm_enter(eos_sm_t *const me);
 
 /* private database functions ----------------------------------------------- */
-eos_inline void eos_db_write_(eos_u8_t type, const char *key, 
+eos_inline void eos_db_write_(eos_u8_t type,
+                                const char *key, eos_topic_t key_id,
                                 const void *memory, eos_u32_t size);
 eos_inline eos_s32_t eos_db_read_(eos_u8_t type,
-                                    const char *key, 
+                                    const char *key, eos_topic_t key_id,
                                     const void *memory, eos_u32_t size);
 
 /* private sm functions ----------------------------------------------------- */
@@ -259,10 +557,13 @@ static eos_s32_t eos_sm_tran(eos_sm_t *const me,
 #endif
 
 /* private heap functions --------------------------------------------------- */
-#if (EOS_USE_EVENT_DATA != 0)
-static void eos_heap_init(eos_heap_t *const me, void *data, eos_u32_t size);
-static void * eos_heap_malloc(eos_heap_t *const me, eos_u32_t size);
-static void eos_heap_free(eos_heap_t *const me, void * data);
+#if (EOS_USE_HEAP_TLSF != 0)
+static inline eos_u32_t heap_fls(eos_u32_t value);
+static inline eos_u32_t heap_block_size(eos_heap_block_t *block);
+static inline eos_heap_block_t *heap_block_next(eos_heap_block_t *block);
+static inline void heap_mapping(eos_u32_t size, eos_u32_t *fl, eos_u32_t *sl);
+static void heap_block_insert(eos_heap_t *const me, eos_heap_block_t *block);
+static void heap_block_remove(eos_heap_t *const me, eos_heap_block_t *block);
 #endif
 
 /* private stream functions ------------------------------------------------- */
@@ -271,42 +572,135 @@ static eos_s32_t eos_stream_init(eos_stream_t *const me,
 static eos_s32_t eos_stream_push(eos_stream_t *me, void * data, eos_u32_t size);
 static eos_s32_t eos_stream_pull_pop(eos_stream_t *me,
                                         void * data, eos_u32_t size);
-static bool eos_stream_full(eos_stream_t *me);
 static eos_s32_t eos_stream_size(eos_stream_t *me);
 static eos_s32_t eos_stream_empty_size(eos_stream_t *me);
+static eos_u32_t eos_stream_span(eos_stream_t *const me, eos_u32_t index,
+                                 eos_u32_t size, eos_db_span_t *span);
+static inline eos_u32_t stream_offset(eos_stream_t *const me, eos_u32_t index);
+static inline eos_u32_t stream_forward(eos_stream_t *const me,
+                                       eos_u32_t index, eos_u32_t size);
+static inline eos_u32_t stream_used(eos_stream_t *const me,
+                                    eos_u32_t head, eos_u32_t tail);
+static eos_stream_t *eos_db_stream_get_(const char *key);
+static eos_u32_t stream_copy_out(eos_stream_t *const me, eos_u32_t index,
+                                 void *data, eos_u32_t size);
+static volatile eos_u32_t *eos_db_stream_cursor_(eos_u16_t e_id);
+static void eos_db_stream_tail_update_(eos_u16_t e_id);
+static void eos_db_stream_overwrite_(eos_u16_t e_id, eos_u32_t size);
+static void eos_db_stream_wake_(eos_u16_t e_id);
+static void eos_db_copy_(void *dst, const void *src, eos_u32_t size);
+static inline eos_db_tail_t *eos_db_tail_(eos_u16_t e_id);
+static eos_u16_t eos_db_value_get_(const char *key);
+static eos_u32_t eos_db_mask_(eos_u32_t size, eos_u32_t offset, eos_u32_t len);
+static bool eos_db_changed_(eos_u16_t e_id, const void *memory,
+                            eos_u32_t offset, eos_u32_t size);
+static void eos_db_value_update_(eos_u16_t e_id, const void *memory,
+                                 eos_u32_t offset, eos_u32_t size);
+static void eos_db_deadband_(const char *key, eos_u8_t type, eos_u32_t band);
+static void eos_db_value_write_(eos_u16_t e_id, const void *memory,
+                                eos_u32_t offset, eos_u32_t size);
+static void eos_db_value_read_(eos_u16_t e_id, void *memory,
+                               eos_u32_t offset, eos_u32_t size);
+static inline bool eos_db_buffered_(eos_u16_t e_id);
+static inline eos_db_version_t *eos_db_version_(eos_u16_t e_id);
+static inline eos_u8_t *eos_db_version_data_(eos_u16_t e_id, eos_u32_t index);
+static eos_u32_t eos_db_version_index_(eos_u16_t e_id, const void *data);
+static eos_u32_t eos_db_version_acquire_(eos_u16_t e_id);
+static void eos_db_version_release_(eos_u16_t e_id, eos_u32_t index);
+static eos_u32_t eos_db_version_reserve_(eos_u16_t e_id);
+static void eos_db_version_commit_(eos_u16_t e_id,
+                                   eos_u32_t index, eos_u32_t mask);
+static void eos_db_version_write_(eos_u16_t e_id, const void *memory,
+                                  eos_u32_t offset, eos_u32_t size);
+static void eos_db_version_read_(eos_u16_t e_id, void *memory,
+                                 eos_u32_t offset, eos_u32_t size);
 
 /* private owner functions -------------------------------------------------- */
+int __eos_ffs(int value);
 static inline bool owner_is_occupied(eos_owner_t *owner, eos_u32_t t_id);
 static inline void owner_or(eos_owner_t *g_owner, eos_owner_t *owner);
 static inline void owner_set_bit(eos_owner_t *owner, eos_u32_t t_id, bool status);
 static inline bool owner_all_cleared(eos_owner_t *owner);
 
+/* private event pool functions --------------------------------------------- */
+static void e_pool_init(eos_event_pool_t *const me);
+static eos_event_data_t *e_pool_get(eos_event_pool_t *const me);
+static void e_pool_put(eos_event_pool_t *const me, eos_event_data_t *e_item);
+
+/* private isr ring functions ----------------------------------------------- */
+#if (EOS_SIZE_ISR_RING != 0)
+static void eos_isr_task_init(void);
+static void eos_isr_task_entry(void *parameter);
+#endif
+
+/* private persistent key functions ----------------------------------------- */
+#if (EOS_USE_DB_PERSIST != 0)
+static void eos_db_persist_mark_(eos_u32_t *bits, eos_u16_t e_id);
+static bool eos_db_persist_collide_(const char *key);
+static void eos_persist_task_entry(void *parameter);
+static eos_u32_t persist_crc(eos_u32_t crc, const void *data, eos_u32_t size);
+static inline eos_u32_t persist_align(eos_u32_t size);
+static void persist_read(eos_u32_t addr, void *data, eos_u32_t size);
+static void persist_write(eos_u32_t addr, const void *data, eos_u32_t size);
+static bool persist_sector_used(eos_u16_t sector);
+static void persist_sector_open(eos_u16_t sector);
+static eos_u32_t persist_sector_walk(eos_u16_t sector, eos_u8_t mode,
+                                     eos_persist_entry_t *entry);
+static eos_persist_entry_t *persist_entry(eos_u32_t hash);
+static void persist_index(eos_u32_t hash, eos_u32_t addr);
+static bool persist_check(eos_u32_t addr, eos_persist_record_t *record);
+static bool persist_recover(eos_persist_entry_t *entry);
+static void persist_collect(eos_u16_t sector, eos_u8_t mode);
+static void persist_head_next(void);
+static void persist_record_write(const eos_persist_record_t *record,
+                                 eos_u32_t addr_value, const void *value);
+static void persist_append(eos_u32_t hash, const void *value, eos_u32_t size);
+static void persist_load(eos_u16_t e_id);
+static void persist_save(eos_u16_t e_id);
+#endif
+
+/* private mailbox functions ------------------------------------------------ */
+static inline bool mailbox_is_empty(eos_mailbox_t *mailbox);
+static inline bool mailbox_is_full(eos_mailbox_t *mailbox);
+static inline void mailbox_push(eos_mailbox_t *mailbox, eos_event_data_t *e_item);
+static inline eos_event_data_t *mailbox_pop(eos_mailbox_t *mailbox);
+static eos_event_data_t *mailbox_take_(eos_mailbox_t *mailbox,
+                                        const eos_wait_set_t *set);
+
 /* extern functions --------------------------------------------------------- */
 extern void eos_kernel_init(void);
 
 /* public functions --------------------------------------------------------- */
 void eos_init(void)
 {
-    eos.e_queue = EOS_NULL;
     for (eos_u16_t i = 0; i < EOS_MAX_TASKS; i++)
     {
         eos.t_id[i] = EOS_MAX_OBJECTS;
+        eos.mailbox[i].head = 0;
+        eos.mailbox[i].tail = 0;
+        eos.mailbox[i].e_hold = EOS_NULL;
+    }
+
+#if (EOS_USE_TIME_EVENT != 0)
+    for (eos_u16_t i = 0; i < EOS_MAX_TIMERS; i++)
+    {
+        eos.timer[i].id = EOS_MAX_OBJECTS;
     }
+#endif
 
+    e_pool_init(&eos.e_pool);
+    eos.count_mailbox_full = 0;
 #if (EOS_USE_EVENT_DATA != 0)
-    eos_heap_init(&eos.heap, eos.heap_data, EOS_SIZE_HEAP);
+    eos_heap_init(&eos.buf_heap, eos.buf_data, sizeof(eos.buf_data));
 #endif
 
-    /* Find the maximum prime in the range of EOS_MAX_OBJECTS. */
-    for (eos_s32_t i = EOS_MAX_OBJECTS; i > 0; i --)
+    /* Find the maximum prime in the range of EOS_MAX_OBJECTS. Only the
+       divisors not larger than the square root are tried. */
+    for (eos_u32_t i = EOS_MAX_OBJECTS; i > 1; i --)
     {
         bool is_prime = true;
-        for (eos_u32_t j = 2; j < EOS_MAX_OBJECTS; j++)
+        for (eos_u32_t j = 2; (j * j) <= i; j ++)
         {
-            if (i <= j)
-            {
-                break;
-            }
             if ((i % j) == 0)
             {
                 is_prime = false;
@@ -320,16 +714,81 @@ void eos_init(void)
         }
     }
     
-    /* Initialize the hash table. */
+    /* Initialize the object table and the hash index. */
     for (eos_u32_t i = 0; i < EOS_MAX_OBJECTS; i++)
     {
         eos.object[i].key = (const char *)0;
+        eos.object[i].block = EOS_MAX_OBJECTS;
+        for (eos_u8_t type = 0; type < EosObj_Max; type ++)
+        {
+            eos.index[type][i] = EOS_MAX_OBJECTS;
+        }
+    }
+
+#if (EOS_USE_TOPIC_TABLE != 0)
+    /* The known keys take the first objects, without any hashing. */
+    for (eos_u16_t i = 0; i < EOS_TOPIC_TABLE_SIZE; i++)
+    {
+        eos.object[i].key = eos_topic_table[i].key;
+        eos.object[i].hash = eos_topic_table[i].hash;
+        eos.object[i].key_len = eos_topic_table[i].key_len;
+        eos.object[i].type = eos_topic_table[i].type;
+        memset(&eos.event[i], 0, sizeof(eos_obj_event_t));
     }
+#endif
 
     eos_kernel_init();
     eos_system_timer_init();
     eos_system_timer_task_init();
     eos_task_idle_init();
+#if (EOS_SIZE_ISR_RING != 0)
+    eos_isr_task_init();
+#endif
+#if (EOS_USE_STATIC_REG != 0)
+    eos_reg_init();
+#endif
+}
+
+void eos_hash_info(eos_hash_info_t * const info)
+{
+    eos_u16_t *count[EosObj_Max] =
+    {
+        &info->count_task, &info->count_event, &info->count_timer
+    };
+
+    memset(info, 0, sizeof(eos_hash_info_t));
+    info->capacity = EOS_MAX_OBJECTS;
+    info->count_known = EOS_TOPIC_TABLE_SIZE;
+    info->ram_object = sizeof(eos.object) + sizeof(eos.index);
+    info->ram_block = sizeof(eos.event) + sizeof(eos.tcb);
+#if (EOS_USE_TIME_EVENT != 0)
+    info->ram_block += sizeof(eos.timer);
+#endif
+
+    register eos_base_t level = eos_hw_interrupt_disable();
+
+    /* The seeking times of one object is its distance to the initial slot. */
+    for (eos_u8_t type = 0; type < EosObj_Max; type ++)
+    {
+        for (eos_u16_t slot = 0; slot < EOS_MAX_OBJECTS; slot ++)
+        {
+            eos_u16_t id = eos.index[type][slot];
+            if (id == EOS_MAX_OBJECTS)
+            {
+                continue;
+            }
+
+            eos_u16_t distance = eos_hash_distance_(slot, id);
+            (*count[type]) ++;
+            info->probe[distance] ++;
+            if (distance > info->probe_max)
+            {
+                info->probe_max = distance;
+            }
+        }
+    }
+
+    eos_hw_interrupt_enable(level);
 }
 
 /* -----------------------------------------------------------------------------
@@ -347,11 +806,17 @@ eos_err_t eos_task_init(eos_task_t *task,
 
     /* Get task id according to the event topic. */
     eos_u16_t t_id = eos_hash_get_index(EosObj_Actor, name);
+#if (EOS_USE_TOPIC_TABLE != 0)
+    /* The known task is in the object table already, but not initialized. */
+    EOS_ASSERT(t_id == EOS_MAX_OBJECTS ||
+               (t_id < EOS_TOPIC_TABLE_SIZE &&
+                eos.object[t_id].block == EOS_MAX_OBJECTS));
+#else
     EOS_ASSERT(t_id == EOS_MAX_OBJECTS);
-    /* Newly create one task in the hash table. */
+#endif
+    /* Newly create one task in the hash table, or use the known one. */
     t_id = eos_hash_insert(EosObj_Actor, name);
     eos.object[t_id].type = EOS_TASK_ATTRIBUTE_TASK;
-    eos.object[t_id].ocb.task.tcb = task;
     task->index = EOS_MAX_TASKS;
     for (eos_u16_t i = 0; i < EOS_MAX_TASKS; i++)
     {
@@ -363,6 +828,14 @@ eos_err_t eos_task_init(eos_task_t *task,
         }
     }
     EOS_ASSERT(task->index != EOS_MAX_TASKS);
+    eos.object[t_id].block = task->index;
+    eos.tcb[task->index] = task;
+    task->event_recv_disable = false;
+    task->wait_set = EOS_NULL;
+    owner_set_bit(&eos.t_recv_disable, task->index, false);
+    eos.mailbox[task->index].head = 0;
+    eos.mailbox[task->index].tail = 0;
+    eos.mailbox[task->index].e_hold = EOS_NULL;
     
 #if (EOS_USE_3RD_KERNEL == 0)
     task->task_handle = (eos_u32_t)(&task->task_);
@@ -377,28 +850,6 @@ eos_err_t eos_task_init(eos_task_t *task,
                         priority, EOS_TIMESLICE);
 }
 
-static bool equeue_no_current_task_event(eos_u16_t t_index)
-{
-    bool ret = true;
-
-    if (eos.e_queue != EOS_NULL)
-    {
-        eos_event_data_t *e_item = eos.e_queue;
-        while (e_item != EOS_NULL)
-        {
-            if (!owner_is_occupied(&e_item->e_owner, t_index))
-            {
-                e_item = e_item->next;
-            }
-
-            ret = false;
-            break;
-        }
-    }
-
-    return ret;
-}
-
 eos_err_t eos_task_delay_no_event(eos_u32_t tick)
 {
     eos_task_handle_t task = eos_task_self();
@@ -406,12 +857,14 @@ eos_err_t eos_task_delay_no_event(eos_u32_t tick)
 
     level = eos_hw_interrupt_disable();
     task->event_recv_disable = true;
+    owner_set_bit(&eos.t_recv_disable, task->index, true);
     eos_hw_interrupt_enable(level);
 
     eos_task_delay(tick);
 
     level = eos_hw_interrupt_disable();
     task->event_recv_disable = false;
+    owner_set_bit(&eos.t_recv_disable, task->index, false);
     eos_hw_interrupt_enable(level);
 
     return EOS_EOK;
@@ -420,157 +873,145 @@ eos_err_t eos_task_delay_no_event(eos_u32_t tick)
 bool eos_task_wait_event(eos_event_t *const e_out, eos_s32_t time_ms)
 {
     eos_task_handle_t task = eos_task_self();
-    eos_err_t ret = eos_sem_take(&task->sem, time_ms);
-    
-    /* disable interrupt */
-    register eos_base_t level = eos_hw_interrupt_disable();
+    eos_mailbox_t *mailbox = &eos.mailbox[task->index];
+    register eos_base_t level;
+
+    /* The payload of the last event is released. */
+    eos_e_item_unhold_(task->index);
+
+    while (1)
+    {
+        /* disable interrupt */
+        level = eos_hw_interrupt_disable();
+
+        /* Take the oldest event data out of the task's mailbox. */
+        if (!mailbox_is_empty(mailbox))
+        {
+            eos_event_data_t *e_item = mailbox_pop(mailbox);
+            eos_e_item_out_(e_item, e_out);
+            eos_e_item_hold_(e_item, task->index);
+
+            /* enable interrupt */
+            eos_hw_interrupt_enable(level);
+
+            return true;
+        }
+
+        /* enable interrupt */
+        eos_hw_interrupt_enable(level);
+
+        /* The mailbox is empty, wait for the next event. */
+        if (eos_sem_take(&task->sem, time_ms) != EOS_EOK)
+        {
+            return false;
+        }
+    }
+}
+
+bool eos_task_wait_specific_event(eos_event_t *const e_out,
+                                    const char *topic, eos_s32_t time_ms)
+{
+    eos_task_handle_t task = eos_task_self();
+    eos_mailbox_t *mailbox = &eos.mailbox[task->index];
+    register eos_base_t level;
+
+    /* The payload of the last event is released. */
+    eos_e_item_unhold_(task->index);
 
-    if (ret == EOS_EOK)
+    while (1)
     {
-        EOS_ASSERT(eos.e_queue != EOS_NULL);
+        level = eos_hw_interrupt_disable();
 
-        /* Find the first event data in e-queue and set it as handled. */
-        eos_event_data_t *e_item = eos.e_queue;
-        while (e_item != EOS_NULL)
+        /* The events before the specific one are handled and dropped. */
+        while (!mailbox_is_empty(mailbox))
         {
-            if (!owner_is_occupied(&e_item->e_owner, task->index))
+            eos_event_data_t *e_item = mailbox_pop(mailbox);
+            bool correct_event = false;
+
+            /* Meet one event */
+            eos_object_t *e_object = &eos.object[e_item->id];
+            EOS_ASSERT(e_object->type == EosObj_Event);
+            if (strcmp(e_object->key, topic) == 0)
             {
-                e_item = e_item->next;
+                correct_event = true;
+                eos_e_item_out_(e_item, e_out);
+                eos_e_item_hold_(e_item, task->index);
             }
             else
             {
-                /* Meet one event */
-                eos_object_t *e_object = &eos.object[e_item->id];
-                EOS_ASSERT(e_object->type == EosObj_Event);
-                eos_u8_t type = e_object->attribute & 0x03;
-                /* Event out */
-                e_out->topic = e_object->key;
-                e_out->eid = e_item->id;
-                if (type == EOS_EVENT_ATTRIBUTE_TOPIC)
-                {
-                    e_out->size = 0;
-                }
-                else if (type == EOS_EVENT_ATTRIBUTE_VALUE)
-                {
-                    e_out->size = e_object->size;
-                }
-                else if (type == EOS_EVENT_ATTRIBUTE_STREAM)
-                {
-                    e_out->size = eos_stream_size(e_object->data.stream);
-                }
-
-                /* If the event data is just the current task's event. */
-                owner_set_bit(&e_item->e_owner, task->index, false);
-                if (owner_all_cleared(&e_item->e_owner))
-                {
-                    eos.object[e_item->id].ocb.event.e_item = EOS_NULL;
-                    /* Delete the event data from the e-queue. */
-                    eos_e_queue_delete_(e_item);
-
-                    if (equeue_no_current_task_event(task->index))
-                    {
-                        eos_sem_reset(&task->sem, 0);
-                    }
-                }
+                eos_e_item_release_(e_item, task->index);
+            }
 
+            if (correct_event)
+            {
                 eos_hw_interrupt_enable(level);
-
                 return true;
             }
         }
-    }
 
-    /* enable interrupt */
-    eos_hw_interrupt_enable(level);
+        eos_hw_interrupt_enable(level);
 
-    return false;
+        if (eos_sem_take(&task->sem, time_ms) != EOS_EOK)
+        {
+            return false;
+        }
+    }
 }
 
-bool eos_task_wait_specific_event(eos_event_t *const e_out,
-                                    const char *topic, eos_s32_t time_ms)
+bool eos_task_wait_any(eos_event_t *const e_out,
+                        const eos_wait_set_t *set, eos_s32_t time_ms)
 {
     eos_task_handle_t task = eos_task_self();
+    eos_mailbox_t *mailbox = &eos.mailbox[task->index];
+    eos_u32_t time_start = eos_tick_get_ms();
+    eos_s32_t time_wait = time_ms;
+    register eos_base_t level;
+
+    EOS_ASSERT(set != EOS_NULL);
+
+    /* The payload of the last event is released. */
+    eos_e_item_unhold_(task->index);
+
     while (1)
     {
-        eos_err_t ret = eos_sem_take(&task->sem, time_ms);
-        
-        register eos_base_t level = eos_hw_interrupt_disable();
+        level = eos_hw_interrupt_disable();
 
-        if (ret == EOS_EOK)
+        /* Take the oldest event in the set, the others are kept in order. */
+        eos_event_data_t *e_item = mailbox_take_(mailbox, set);
+        if (e_item != EOS_NULL)
         {
-            EOS_ASSERT(eos.e_queue != EOS_NULL);
-            /* Find the first event data in e-queue and set it as handled. */
-            eos_event_data_t *e_item = eos.e_queue;
-            while (e_item != EOS_NULL)
-            {
-                if (!owner_is_occupied(&e_item->e_owner, task->index))
-                {
-                    e_item = e_item->next;
-                }
-                else
-                {
-                    bool correct_event = false;
+            task->wait_set = EOS_NULL;
+            eos_e_item_out_(e_item, e_out);
+            eos_e_item_hold_(e_item, task->index);
+            eos_hw_interrupt_enable(level);
 
-                    /* Meet one event */
-                    eos_object_t *e_object = &eos.object[e_item->id];
-                    EOS_ASSERT(e_object->type == EosObj_Event);
-                    if (strcmp(e_object->key, topic) == 0)
-                    {
-                        correct_event = true;
-                    }
-
-                    if (correct_event)
-                    {
-                        eos_u8_t type = e_object->attribute & 0x03;
-                        /* Event out */
-                        e_out->topic = e_object->key;
-                        e_out->eid = e_item->id;
-                        if (type == EOS_EVENT_ATTRIBUTE_TOPIC)
-                        {
-                            e_out->size = 0;
-                        }
-                        else if (type == EOS_EVENT_ATTRIBUTE_VALUE)
-                        {
-                            e_out->size = e_object->size;
-                        }
-                        else if (type == EOS_EVENT_ATTRIBUTE_STREAM)
-                        {
-                            e_out->size = eos_stream_size(e_object->data.stream);
-                        }
-                    }
+            return true;
+        }
 
-                    /* If the event data is just the current task's event. */
-                    owner_set_bit(&e_item->e_owner, task->index, false);
-                    if (owner_all_cleared(&e_item->e_owner))
-                    {
-                        eos.object[e_item->id].ocb.event.e_item = EOS_NULL;
-                        /* Delete the event data from the e-queue. */
-                        eos_e_queue_delete_(e_item);
-
-                        if (equeue_no_current_task_event(task->index))
-                        {
-                            eos_sem_reset(&task->sem, 0);
-                        }
-                    }
+        /* The givers only wake up this task by the events in the set. */
+        task->wait_set = set;
+        eos_hw_interrupt_enable(level);
 
-                    if (correct_event)
-                    {
-                        eos_hw_interrupt_enable(level);
-                        return true;
-                    }
-                    else
-                    {
-                        continue;
-                    }
-                }
+        /* The semaphore may be released by the events given before waiting,
+           so the waiting time is counted from the start. */
+        if (time_ms > 0)
+        {
+            time_wait = time_ms - (eos_s32_t)(eos_tick_get_ms() - time_start);
+            if (time_wait < 0)
+            {
+                time_wait = 0;
             }
         }
 
-        eos_hw_interrupt_enable(level);
-        break;
-    }
+        if (eos_sem_take(&task->sem, time_wait) != EOS_EOK)
+        {
+            level = eos_hw_interrupt_disable();
+            task->wait_set = EOS_NULL;
+            eos_hw_interrupt_enable(level);
 
-    return false;
+            return false;
+        }
+    }
 }
 
 /* -----------------------------------------------------------------------------
@@ -581,12 +1022,8 @@ void eos_event_attribute_global(const char *topic)
     /* disable interrupt */
     register eos_base_t level = eos_hw_interrupt_disable();
 
-    eos_u16_t e_id;
-    if (eos_hash_existed(EosObj_Event, topic) == false)
-    {
-        e_id = eos_hash_insert(EosObj_Event, topic);
-        eos.object[e_id].type = EosObj_Event;
-    }
+    /* The existing event is returned, or a new one is created. */
+    eos_u16_t e_id = eos_hash_insert(EosObj_Event, topic);
     EOS_ASSERT(eos.object[e_id].type == EosObj_Event);
     eos.object[e_id].attribute |= EOS_EVENT_ATTRIBUTE_GLOBAL;
     
@@ -594,24 +1031,6 @@ void eos_event_attribute_global(const char *topic)
     eos_hw_interrupt_enable(level);
 }
 
-void eos_event_attribute_unblocked(const char *topic)
-{
-    /* disable interrupt */
-    register eos_base_t level = eos_hw_interrupt_disable();
-
-    eos_u16_t e_id;
-    if (eos_hash_existed(EosObj_Event, topic) == false)
-    {
-        e_id = eos_hash_insert(EosObj_Event, topic);
-        eos.object[e_id].type = EosObj_Event;
-    }
-    EOS_ASSERT(eos.object[e_id].type == EosObj_Event);
-    eos.object[e_id].attribute |= EOS_EVENT_ATTRIBUTE_UNBLOCKED;
-
-    /* enable interrupt */
-    eos_hw_interrupt_enable(level);
-}
-
 static void eos_task_function(void *parameter)
 {
     (void)parameter;
@@ -652,47 +1071,108 @@ static void eos_task_function(void *parameter)
     }
 }
 
-static void eos_e_queue_delete_(eos_event_data_t const *item)
+static void eos_e_item_out_(eos_event_data_t const *e_item,
+                            eos_event_t * const e_out)
 {
-    /* parameter check */
-    EOS_ASSERT(eos.e_queue != EOS_NULL);
-    EOS_ASSERT(item != EOS_NULL);
-
-    /* disable interrupt */
-    register eos_base_t level = eos_hw_interrupt_disable();
-    
-    /* If the event data is only one in queue. */
-    if (item->last == EOS_NULL && item->next == EOS_NULL)
+    eos_object_t *e_object = &eos.object[e_item->id];
+    EOS_ASSERT(e_object->type == EosObj_Event);
+    eos_u8_t type = e_object->attribute & 0x03;
+
+    /* Event out */
+    e_out->topic = e_object->key;
+    e_out->eid = e_item->id;
+    e_out->data = e_item->buf;
+    e_out->value = e_item->value;
+    if (type == EOS_EVENT_ATTRIBUTE_TOPIC)
     {
-        EOS_ASSERT(eos.e_queue == item);
-        eos.e_queue = EOS_NULL;
+        e_out->size = 0;
+#if (EOS_USE_EVENT_DATA != 0)
+        if (e_item->buf != EOS_NULL)
+        {
+            e_out->size = ((eos_event_buf_t *)e_item->buf - 1)->size;
+        }
+#endif
     }
-    /* If the event data is the first one in queue. */
-    else if (item->last == EOS_NULL && item->next != EOS_NULL)
+    else if (type == EOS_EVENT_ATTRIBUTE_VALUE)
     {
-        EOS_ASSERT(eos.e_queue == item);
-        item->next->last = EOS_NULL;
-        eos.e_queue = item->next;
+        e_out->size = e_object->size;
     }
-    /* If the event item is the last one in queue. */
-    else if (item->last != EOS_NULL && item->next == EOS_NULL)
+    else if (type == EOS_EVENT_ATTRIBUTE_STREAM)
     {
-        item->last->next = EOS_NULL;
+        /* The broadcast stream is only read by its subscribers. */
+        eos_stream_t *queue = eos.event[e_item->id].data.stream;
+        eos_u8_t attribute = eos.object[e_item->id].attribute;
+        e_out->size = 0;
+        if ((attribute & EOS_DB_ATTRIBUTE_BROADCAST) == 0 ||
+            owner_is_occupied(&eos.event[e_item->id].e_sub,
+                              eos_task_self()->index))
+        {
+            e_out->size = stream_used(queue, queue->head,
+                                      *eos_db_stream_cursor_(e_item->id));
+        }
     }
-    /* If the event item is in the middle position of the queue. */
-    else
+}
+
+static void eos_e_item_release_(eos_event_data_t *e_item, eos_u16_t t_index)
+{
+    /* parameter check */
+    EOS_ASSERT(e_item != EOS_NULL);
+    EOS_ASSERT(owner_is_occupied(&e_item->e_owner, t_index));
+
+    /* disable interrupt */
+    register eos_base_t level = eos_hw_interrupt_disable();
+
+    /* The event data is freed when the last owner releases it. */
+    owner_set_bit(&e_item->e_owner, t_index, false);
+    if (owner_all_cleared(&e_item->e_owner))
     {
-        item->last->next = item->next;
-        item->next->last = item->last;
+        if (eos.event[e_item->id].e_item == e_item)
+        {
+            eos.event[e_item->id].e_item = EOS_NULL;
+        }
+
+        /* free the event data. */
+#if (EOS_USE_EVENT_DATA != 0)
+        if (e_item->buf != EOS_NULL)
+        {
+            eos_event_buf_free_(e_item->buf);
+        }
+#endif
+        e_pool_put(&eos.e_pool, e_item);
     }
-    
-    /* free the event data. */
-    eos_heap_free(&eos.heap, (void *)item);
 
     /* enable interrupt */
     eos_hw_interrupt_enable(level);
 }
 
+/* The event with payload is held by the task until its next waiting, so the
+   payload can be read without any copy. */
+static void eos_e_item_hold_(eos_event_data_t *e_item, eos_u16_t t_index)
+{
+    if (e_item->buf != EOS_NULL)
+    {
+        eos.mailbox[t_index].e_hold = e_item;
+    }
+    else
+    {
+        eos_e_item_release_(e_item, t_index);
+    }
+}
+
+static void eos_e_item_unhold_(eos_u16_t t_index)
+{
+    register eos_base_t level = eos_hw_interrupt_disable();
+
+    eos_event_data_t *e_item = eos.mailbox[t_index].e_hold;
+    if (e_item != EOS_NULL)
+    {
+        eos.mailbox[t_index].e_hold = EOS_NULL;
+        eos_e_item_release_(e_item, t_index);
+    }
+
+    eos_hw_interrupt_enable(level);
+}
+
 /* Reactor ------------------------------------------------------------------ */
 void eos_reactor_init(  eos_reactor_t *const me,
                         const char *name,
@@ -718,7 +1198,8 @@ void eos_reactor_start(eos_reactor_t *const me, eos_event_handler event_handler)
     eos_u16_t t_id = eos.t_id[me->super.index];
     eos_event_give_(eos.object[t_id].key,
                     EOS_MAX_OBJECTS,
-                    EosEventGiveType_Send, "Event_Null");
+                    EosEventGiveType_Send, "Event_Null", EOS_MAX_OBJECTS,
+                    EOS_NULL, 0);
     
     eos_task_startup(&me->super);
 }
@@ -750,7 +1231,8 @@ void eos_sm_start(eos_sm_t *const me, eos_state_handler state_init)
     eos_u16_t t_id = eos.t_id[me->super.index];
     eos_event_give_(eos.object[t_id].key,
                     EOS_MAX_OBJECTS,
-                    EosEventGiveType_Send, "Event_Null");
+                    EosEventGiveType_Send, "Event_Null", EOS_MAX_OBJECTS,
+                    EOS_NULL, 0);
 
     eos_task_startup(&me->super);
 }
@@ -760,7 +1242,7 @@ static void eos_reactor_enter(eos_reactor_t *const me)
 {
     eos_event_t e =
     {
-        "Event_Enter", 0, 0,
+        "Event_Enter", 0, 0, EOS_NULL, 0,
     };
     me->event_handler(me, &e);
 }
@@ -816,7 +1298,8 @@ Event
 ----------------------------------------------------------------------------- */
 static eos_s8_t eos_event_give_(const char *task, eos_u32_t task_id,
                                 eos_u8_t give_type,
-                                const char *topic)
+                                const char *topic, eos_topic_t topic_id,
+                                void *buf, eos_u32_t value)
 {
     eos_s8_t ret = 0;
     eos_sem_handle_t sem = EOS_NULL;
@@ -845,7 +1328,9 @@ static eos_s8_t eos_event_give_(const char *task, eos_u32_t task_id,
             t_id = task_id;
         }
         
-        tcb = eos.object[t_id].ocb.task.tcb;
+        tcb = eos_obj_task_(t_id);
+        /* If this assert is trigged, the known task is not initialized. */
+        EOS_ASSERT_NAME(tcb != EOS_NULL, task);
         if (tcb->event_recv_disable == true)
         {
             goto exit;
@@ -860,21 +1345,43 @@ static eos_s8_t eos_event_give_(const char *task, eos_u32_t task_id,
         EOS_ASSERT(0);
     }
     
-    /* Get event id according to the event topic. */
-    e_id = eos_hash_get_index(EosObj_Event, topic);
-    if (e_id == EOS_MAX_OBJECTS)
+    /* Get event id according to the topic handle or the event topic. */
+    if (topic_id != EOS_MAX_OBJECTS)
     {
-        /* Newly create one event in the hash table. */
-        e_id = eos_hash_insert(EosObj_Event, topic);
-        eos.object[e_id].type = EosObj_Event;
-        eos.object[e_id].attribute &= (~0x03);
-        e_type = EOS_EVENT_ATTRIBUTE_TOPIC;
+        EOS_ASSERT(topic == EOS_NULL && topic_id < EOS_MAX_OBJECTS);
+        EOS_ASSERT(eos.object[topic_id].type == EosObj_Event);
+        e_id = topic_id;
+        topic = eos.object[e_id].key;
+        e_type = eos.object[e_id].attribute & 0x03;
     }
     else
     {
-        /* Get the type of the event. */
-        e_type = eos.object[e_id].attribute & 0x03;
-        EOS_ASSERT(eos.object[e_id].type == EosObj_Event);
+        e_id = eos_hash_get_index(EosObj_Event, topic);
+        if (e_id == EOS_MAX_OBJECTS)
+        {
+            /* Newly create one event in the hash table. */
+            e_id = eos_hash_insert(EosObj_Event, topic);
+            eos.object[e_id].type = EosObj_Event;
+            eos.object[e_id].attribute &= (~0x03);
+            e_type = EOS_EVENT_ATTRIBUTE_TOPIC;
+        }
+        else
+        {
+            /* Get the type of the event. */
+            e_type = eos.object[e_id].attribute & 0x03;
+            EOS_ASSERT(eos.object[e_id].type == EosObj_Event);
+        }
+    }
+    /* Only the topic-type event carries the payload buffer or inline value. */
+    EOS_ASSERT((buf == EOS_NULL && value == 0) ||
+               e_type == EOS_EVENT_ATTRIBUTE_TOPIC);
+
+    /* The value event is not given again if the value is not changed. */
+    if (e_type == EOS_EVENT_ATTRIBUTE_VALUE &&
+        (eos.object[e_id].attribute & EOS_DB_ATTRIBUTE_ON_CHANGE) != 0 &&
+        eos_db_tail_(e_id)->dirty == 0)
+    {
+        goto exit;
     }
     
     eos_owner_t g_owner;
@@ -883,13 +1390,6 @@ static eos_s8_t eos_event_give_(const char *task, eos_u32_t task_id,
     /* The send-type event. */
     if (give_type == EosEventGiveType_Send)
     {
-        /* If the current task is waiting for a specific event, but not the
-           current event. */
-        if (tcb->wait_specific_event == true &&
-            strcmp(topic, tcb->event_wait) != 0)
-        {
-            goto exit;
-        }
         if (eos_task_get_state(tcb) == EOS_TASK_SUSPEND)
         {
             goto exit;
@@ -898,108 +1398,97 @@ static eos_s8_t eos_event_give_(const char *task, eos_u32_t task_id,
         {
             goto exit;
         }
-        g_owner.data[tcb->index / 8] = (1 << (tcb->index % 8));
+        owner_set_bit(&g_owner, tcb->index, true);
     }
     /* The publish-type event. */
     else if (give_type == EosEventGiveType_Publish)
     {
-        memcpy(&g_owner, &eos.object[e_id].ocb.event.e_sub, sizeof(eos_owner_t));
+        /* The tasks disabling event receiving are masked out at once. */
+        eos_owner_t *e_sub = &eos.event[e_id].e_sub;
+        for (eos_u32_t i = 0; i < EOS_MAX_OWNER; i++)
+        {
+            g_owner.data[i] = e_sub->data[i] & ~eos.t_recv_disable.data[i];
+        }
 
-        /* The suspended task does not receive any event. */
-        for (eos_u16_t i = 0; i < EOS_MAX_TASKS; i++)
+        /* The suspended task does not receive any event. Only the subscribers
+           are checked. */
+        for (eos_u32_t i = 0; i < EOS_MAX_OWNER; i++)
         {
-            if (eos.t_id[i] != EOS_MAX_OBJECTS)
+            eos_u32_t bits = g_owner.data[i];
+            while (bits != 0)
             {
-                eos_u16_t _t_id = eos.t_id[i];
-                eos_object_t *obj = &eos.object[_t_id];
+                eos_u16_t t_index = (i << 5) + __eos_ffs((int)bits) - 1;
+                bits &= (bits - 1);
 
-                if (obj->ocb.task.tcb->event_recv_disable == true)
+                if (eos_task_get_state(eos.tcb[t_index]) == EOS_TASK_SUSPEND)
                 {
-                    owner_set_bit(&g_owner, i, false);
-                }
-                if (eos_task_get_state(obj->ocb.task.tcb) == EOS_TASK_SUSPEND)
-                {
-                    owner_set_bit(&g_owner, i, false);
+                    owner_set_bit(&g_owner, t_index, false);
                 }
             }
         }
-        
+
+
         if (owner_all_cleared(&g_owner) == true)
         {
             goto exit;
         }
     }
 
+    eos_event_data_t *e_item;
+
     /* If the event type is topic-type. */
     if (e_type == EOS_EVENT_ATTRIBUTE_TOPIC)
     {
-        eos_event_data_t *data
-            = eos_heap_malloc(&eos.heap, sizeof(eos_event_data_t));
-        EOS_ASSERT(data != EOS_NULL);
-        data->id = e_id;
-        memset(&data->e_owner, 0, sizeof(eos_owner_t));
-        owner_or(&data->e_owner, &g_owner);
-        data->time = eos_tick_get_ms();
-
-        /* Attach the event data to the event queue. */
-        if (eos.e_queue == EOS_NULL)
+        e_item = e_pool_get(&eos.e_pool);
+        if (e_item == EOS_NULL)
         {
-            eos.e_queue = data;
-            data->next = EOS_NULL;
-            data->last = EOS_NULL;
-        }
-        else
-        {
-            eos_event_data_t *edata = eos.e_queue;
-            while (edata->next != EOS_NULL)
-            {
-                edata = edata->next;
-            }
-            data->next = EOS_NULL;
-            edata->next = data;
-            data->last = edata;
+            /* The event is dropped and counted, when the pool is exhausted. */
+            ret = (eos_s8_t)EOS_ERROR;
+            goto exit;
         }
+        e_item->id = e_id;
+        memset(&e_item->e_owner, 0, sizeof(eos_owner_t));
+        e_item->time = eos_tick_get_ms();
+
+        /* The payload buffer is owned by the event data from now on. */
+        e_item->buf = buf;
+        buf = EOS_NULL;
+        e_item->value = value;
     }
     /* If the event is value-type or stream-type. */
     else if (e_type == EOS_EVENT_ATTRIBUTE_VALUE ||
              e_type == EOS_EVENT_ATTRIBUTE_STREAM)
     {
-        if (eos.object[e_id].ocb.event.e_item == EOS_NULL)
+        if (eos.event[e_id].e_item == EOS_NULL)
         {
-            eos_event_data_t *data;
-
             /* Apply one data for the event. */
-            data = eos_heap_malloc(&eos.heap, sizeof(eos_event_data_t));
-            EOS_ASSERT_NAME(data != EOS_NULL, topic);
-            memset(&data->e_owner, 0, sizeof(eos_owner_t));
-            owner_or(&data->e_owner, &g_owner);
-            data->id = e_id;
-            data->time = eos_tick_get_ms();
-            eos.object[e_id].ocb.event.e_item = data;
-            
-            /* Attach the event data to the event queue. */
-            if (eos.e_queue == EOS_NULL)
-            {
-                eos.e_queue = data;
-                data->next = EOS_NULL;
-                data->last = EOS_NULL;
-            }
-            else
+            e_item = e_pool_get(&eos.e_pool);
+            if (e_item == EOS_NULL)
             {
-                eos_event_data_t *edata = eos.e_queue;
-                while (edata->next != EOS_NULL)
-                {
-                    edata = edata->next;
-                }
-                data->next = EOS_NULL;
-                edata->next = data;
-                data->last = edata;
+                ret = (eos_s8_t)EOS_ERROR;
+                goto exit;
             }
+            memset(&e_item->e_owner, 0, sizeof(eos_owner_t));
+            e_item->id = e_id;
+            e_item->buf = EOS_NULL;
+            e_item->value = 0;
+            eos.event[e_id].e_item = e_item;
         }
-        else
+        e_item = eos.event[e_id].e_item;
+        e_item->time = eos_tick_get_ms();
+
+        /* The value event reports the regions written since the last one. */
+        if (e_type == EOS_EVENT_ATTRIBUTE_VALUE)
+        {
+            eos_db_tail_t *tail = eos_db_tail_(e_id);
+            e_item->value |= tail->dirty;
+            tail->dirty = 0;
+        }
+
+        /* The tasks which already own the event data are not notified again. */
+        for (eos_u32_t i = 0; i < EOS_MAX_OWNER; i++)
         {
-            owner_or(&eos.object[e_id].ocb.event.e_item->e_owner, &g_owner);
-            eos.object[e_id].ocb.event.e_item->time = eos_tick_get_ms();
+            g_owner.data[i] &= ~e_item->e_owner.data[i];
         }
     }
     /* Event has no other type. */
@@ -1007,67 +1496,97 @@ static eos_s8_t eos_event_give_(const char *task, eos_u32_t task_id,
     {
         EOS_ASSERT(0);
     }
+    owner_or(&e_item->e_owner, &g_owner);
 
-    /* Check if the related tasks are waiting for the specific event or not. */
-    for (eos_u16_t i = 0; i < EOS_MAX_TASKS; i++)
+    /* Put the event data into the mailboxes of its new owners, and wake up the
+       related tasks. Only the set bits are iterated. */
+    for (eos_u32_t i = 0; i < EOS_MAX_OWNER; i++)
     {
-        if (eos.t_id[i] != EOS_MAX_OBJECTS)
+        eos_u32_t bits = g_owner.data[i];
+        while (bits != 0)
         {
-            eos_u16_t _t_id = eos.t_id[i];
-            eos_object_t *obj = &eos.object[_t_id];
+            eos_u16_t t_index = (i << 5) + __eos_ffs((int)bits) - 1;
+            bits &= (bits - 1);
 
-            if (eos_interrupt_get_nest() == 0)
+            /* The event is dropped and counted for the task whose mailbox is
+               full, like the exhausted pool. The other owners still get it. */
+            if (mailbox_is_full(&eos.mailbox[t_index]))
             {
-                if (owner_is_occupied(&g_owner, obj->ocb.task.tcb->index) &&
-                    obj->ocb.task.tcb != eos_task_self())
+                eos.count_mailbox_full ++;
+                ret = (eos_s8_t)EOS_ERROR;
+                owner_set_bit(&e_item->e_owner, t_index, false);
+                if (owner_all_cleared(&e_item->e_owner))
                 {
-                    if (!obj->ocb.task.tcb->wait_specific_event)
+                    if (eos.event[e_id].e_item == e_item)
                     {
-                        sem = &obj->ocb.task.tcb->sem;
-                        eos_sem_release(sem);
-                        eos_hw_interrupt_enable(level);
-                        level = eos_hw_interrupt_disable();
+                        eos.event[e_id].e_item = EOS_NULL;
                     }
-                    else
+#if (EOS_USE_EVENT_DATA != 0)
+                    if (e_item->buf != EOS_NULL)
                     {
-                        if (strcmp(topic, obj->ocb.task.tcb->event_wait) == 0)
-                        {
-                            sem = &obj->ocb.task.tcb->sem;
-                            eos_sem_release(sem);
-                            eos_hw_interrupt_enable(level);
-                            level = eos_hw_interrupt_disable();
-                        }
+                        eos_event_buf_free_(e_item->buf);
                     }
+#endif
+                    e_pool_put(&eos.e_pool, e_item);
                 }
+                continue;
             }
-            else
+            mailbox_push(&eos.mailbox[t_index], e_item);
+
+            /* The task waiting for a set of events is only woken up by the
+               events in the set, by one bit test. */
+            eos_task_handle_t tcb_owner = eos.tcb[t_index];
+            if (tcb_owner->wait_set != EOS_NULL &&
+                (tcb_owner->wait_set->data[e_id >> 5] &
+                 (1U << (e_id & 31))) == 0)
+            {
+                continue;
+            }
+
+            if (eos_interrupt_get_nest() == 0)
             {
-                if (owner_is_occupied(&g_owner, obj->ocb.task.tcb->index))
+                if (tcb_owner != eos_task_self())
                 {
-                    if (!obj->ocb.task.tcb->wait_specific_event)
-                    {
-                        sem = &obj->ocb.task.tcb->sem;
-                        eos_sem_release(sem);
-                    }
-                    else
-                    {
-                        if (strcmp(topic, obj->ocb.task.tcb->event_wait) == 0)
-                        {
-                            sem = &obj->ocb.task.tcb->sem;
-                            eos_sem_release(sem);
-                        }
-                    }
+                    sem = &tcb_owner->sem;
+                    eos_sem_release(sem);
+                    eos_hw_interrupt_enable(level);
+                    level = eos_hw_interrupt_disable();
                 }
             }
+            else
+            {
+                sem = &tcb_owner->sem;
+                eos_sem_release(sem);
+            }
         }
     }
 
 exit:
+#if (EOS_USE_EVENT_DATA != 0)
+    /* The payload buffer is freed if the event is not given to any task. */
+    if (buf != EOS_NULL)
+    {
+        eos_event_buf_free_(buf);
+    }
+#endif
     eos_hw_interrupt_enable(level);
 
     return ret;
 }
 
+void eos_wait_set_clear(eos_wait_set_t *const set)
+{
+    memset(set, 0, sizeof(eos_wait_set_t));
+}
+
+void eos_wait_set_add(eos_wait_set_t *const set, eos_topic_t topic)
+{
+    EOS_ASSERT(topic < EOS_MAX_OBJECTS);
+    EOS_ASSERT(eos.object[topic].type == EosObj_Event);
+
+    set->data[topic >> 5] |= (1U << (topic & 31));
+}
+
 eos_u32_t eos_get_task_id(const char *task)
 {
     eos_u16_t t_id = eos_hash_get_index(EosObj_Actor, task);
@@ -1079,52 +1598,272 @@ eos_u32_t eos_get_task_id(const char *task)
 
 void eos_event_send(const char *task, const char *topic)
 {
-    eos_event_give_(task, EOS_MAX_OBJECTS, EosEventGiveType_Send, topic);
+    eos_event_give_(task, EOS_MAX_OBJECTS,
+                    EosEventGiveType_Send, topic, EOS_MAX_OBJECTS,
+                    EOS_NULL, 0);
 }
 
 void eos_event_send_id(eos_u32_t task_id, const char *topic)
 {
-    eos_event_give_(NULL, task_id, EosEventGiveType_Send, topic);
+    eos_event_give_(EOS_NULL, task_id,
+                    EosEventGiveType_Send, topic, EOS_MAX_OBJECTS,
+                    EOS_NULL, 0);
+}
+
+void eos_event_send_h(eos_u32_t task_id, eos_topic_t topic)
+{
+    eos_event_give_(EOS_NULL, task_id,
+                    EosEventGiveType_Send, EOS_NULL, topic,
+                    EOS_NULL, 0);
 }
 
 void eos_event_publish(const char *topic)
 {
-    eos_event_give_(EOS_NULL, EOS_MAX_OBJECTS, EosEventGiveType_Publish, topic);
+    eos_event_give_(EOS_NULL, EOS_MAX_OBJECTS,
+                    EosEventGiveType_Publish, topic, EOS_MAX_OBJECTS,
+                    EOS_NULL, 0);
+}
+
+void eos_event_publish_h(eos_topic_t topic)
+{
+    eos_event_give_(EOS_NULL, EOS_MAX_OBJECTS,
+                    EosEventGiveType_Publish, EOS_NULL, topic,
+                    EOS_NULL, 0);
+}
+
+void eos_event_send_u32(const char *task, const char *topic, eos_u32_t value)
+{
+    eos_event_give_(task, EOS_MAX_OBJECTS,
+                    EosEventGiveType_Send, topic, EOS_MAX_OBJECTS,
+                    EOS_NULL, value);
+}
+
+void eos_event_send_u32_h(eos_u32_t task_id,
+                            eos_topic_t topic, eos_u32_t value)
+{
+    eos_event_give_(EOS_NULL, task_id,
+                    EosEventGiveType_Send, EOS_NULL, topic,
+                    EOS_NULL, value);
+}
+
+void eos_event_publish_u32(const char *topic, eos_u32_t value)
+{
+    eos_event_give_(EOS_NULL, EOS_MAX_OBJECTS,
+                    EosEventGiveType_Publish, topic, EOS_MAX_OBJECTS,
+                    EOS_NULL, value);
 }
 
-static inline void eos_event_sub_(eos_task_handle_t const me, const char *topic)
+void eos_event_publish_u32_h(eos_topic_t topic, eos_u32_t value)
 {
+    eos_event_give_(EOS_NULL, EOS_MAX_OBJECTS,
+                    EosEventGiveType_Publish, EOS_NULL, topic,
+                    EOS_NULL, value);
+}
+
+#if (EOS_SIZE_ISR_RING != 0)
+bool eos_event_publish_from_isr(eos_topic_t topic, eos_u32_t value)
+{
+    eos_isr_ring_t *ring = &eos.isr_ring;
+    bool ret = true;
+
+    /* Only the recording is protected, which is short and in constant time, as
+       the nested ISRs may publish events at the same time. */
     register eos_base_t level = eos_hw_interrupt_disable();
 
-    /* Find the object by the event topic. */
-    eos_u16_t index;
-    index = eos_hash_get_index(EosObj_Event, topic);
-    if (index == EOS_MAX_OBJECTS)
+    eos_u16_t used = (eos_u16_t)(ring->head - ring->tail);
+    if (used >= EOS_SIZE_ISR_RING)
     {
-        index = eos_hash_insert(EosObj_Event, topic);
-        eos.object[index].type = EosObj_Event;
-        eos.object[index].attribute &=~ EOS_EVENT_ATTRIBUTE_MASK;
+        ring->count_overflow ++;
+        ret = false;
     }
     else
     {
-        EOS_ASSERT(eos.object[index].type == EosObj_Event);
-
-        /* The stream event can only be subscribed by one task. */
-        eos_u8_t e_type = eos.object[index].attribute & 0x03;
-        if (e_type == EOS_EVENT_ATTRIBUTE_STREAM)
+        eos_isr_event_t *e = &ring->event[ring->head & (EOS_SIZE_ISR_RING - 1)];
+        e->topic = topic;
+        e->value = value;
+        ring->head ++;
+        if ((used + 1) > ring->count_used_max)
         {
-            EOS_ASSERT(owner_all_cleared(&eos.object[index].ocb.event.e_sub));
+            ring->count_used_max = used + 1;
         }
     }
 
+    /* Wake up the ISR task only once until it starts to work. */
+    bool signal = false;
+    if (ret == true && ring->signaled == false)
+    {
+        ring->signaled = true;
+        signal = true;
+    }
+
+    eos_hw_interrupt_enable(level);
+
+    if (signal == true)
+    {
+        eos_sem_release(&ring->sem);
+    }
+
+    return ret;
+}
+
+void eos_event_isr_info(eos_event_isr_info_t * const info)
+{
+    register eos_base_t level = eos_hw_interrupt_disable();
+
+    info->capacity = EOS_SIZE_ISR_RING;
+    info->used_max = eos.isr_ring.count_used_max;
+    info->overflow = eos.isr_ring.count_overflow;
+
+    eos_hw_interrupt_enable(level);
+}
+#endif
+
+#if (EOS_USE_EVENT_DATA != 0)
+void *eos_event_buf_alloc(eos_u32_t size)
+{
+    register eos_base_t level = eos_hw_interrupt_disable();
+
+    eos_event_buf_t *header =
+        eos_heap_malloc(&eos.buf_heap, sizeof(eos_event_buf_t) + size);
+    if (header != EOS_NULL)
+    {
+        header->size = size;
+        header ++;
+    }
+
+    eos_hw_interrupt_enable(level);
+
+    return (void *)header;
+}
+
+void eos_event_buf_free(void *buf)
+{
+    register eos_base_t level = eos_hw_interrupt_disable();
+    eos_event_buf_free_(buf);
+    eos_hw_interrupt_enable(level);
+}
+
+void eos_event_publish_buf(const char *topic, void *buf)
+{
+    EOS_ASSERT(buf != EOS_NULL);
+
+    eos_event_give_(EOS_NULL, EOS_MAX_OBJECTS,
+                    EosEventGiveType_Publish, topic, EOS_MAX_OBJECTS,
+                    buf, 0);
+}
+
+static void eos_event_buf_free_(void *buf)
+{
+    eos_heap_free(&eos.buf_heap, (void *)((eos_event_buf_t *)buf - 1));
+    /* If this assert is trigged, the buffer is not from eos_event_buf_alloc(),
+       or it is freed twice. */
+    EOS_ASSERT(eos.buf_heap.error_id == 0);
+}
+#endif
+
+eos_topic_t eos_topic_get(const char *topic)
+{
+    register eos_base_t level = eos_hw_interrupt_disable();
+
+    /* Find the object by the event topic, or create it. */
+    eos_u16_t e_id = eos_hash_get_index(EosObj_Event, topic);
+    if (e_id == EOS_MAX_OBJECTS)
+    {
+        e_id = eos_hash_insert(EosObj_Event, topic);
+        eos.object[e_id].type = EosObj_Event;
+        eos.object[e_id].attribute &=~ EOS_EVENT_ATTRIBUTE_MASK;
+    }
+    EOS_ASSERT_NAME(eos.object[e_id].type == EosObj_Event, topic);
+
+    eos_hw_interrupt_enable(level);
+
+    return (eos_topic_t)e_id;
+}
+
+void eos_event_pool_info(eos_event_pool_info_t * const info)
+{
+    register eos_base_t level = eos_hw_interrupt_disable();
+
+    info->capacity = EOS_MAX_EVENT_RECORD;
+    info->free = eos.e_pool.count_free;
+    info->free_min = eos.e_pool.count_free_min;
+    info->exhausted = eos.e_pool.count_exhausted;
+    info->mailbox_full = eos.count_mailbox_full;
+
+    eos_hw_interrupt_enable(level);
+}
+
+eos_topic_t eos_topic_get_hashed(const char *topic, eos_u32_t hash)
+{
+    register eos_base_t level = eos_hw_interrupt_disable();
+
+    /* Find the object by the precomputed hash value and the topic string,
+       or create it. The string is compared, but not hashed again. */
+    eos_u16_t e_id = eos_hash_get_index_hashed(EosObj_Event, hash, topic);
+    if (e_id == EOS_MAX_OBJECTS)
+    {
+        /* The string is only hashed once in the registration. If this assert
+           is trigged, the topic hash is not calculated by EOS_TOPIC(). */
+        EOS_ASSERT_NAME(eos_hash_time33(ch_type[EosObj_Event], topic) == hash,
+                        topic);
+        e_id = eos_hash_insert(EosObj_Event, topic);
+        eos.object[e_id].type = EosObj_Event;
+        eos.object[e_id].attribute &=~ EOS_EVENT_ATTRIBUTE_MASK;
+    }
+
+    eos_hw_interrupt_enable(level);
+
+    return (eos_topic_t)e_id;
+}
+
+static inline void eos_event_sub_(eos_task_handle_t const me, eos_topic_t e_id)
+{
+    EOS_ASSERT(e_id < EOS_MAX_OBJECTS);
+    EOS_ASSERT(eos.object[e_id].type == EosObj_Event);
+
+    register eos_base_t level = eos_hw_interrupt_disable();
+
+    /* The stream event can only be subscribed by one task, except the
+       broadcast one. */
+    eos_u8_t attribute = eos.object[e_id].attribute;
+    eos_u8_t e_type = attribute & 0x03;
+    if (e_type == EOS_EVENT_ATTRIBUTE_STREAM &&
+        (attribute & EOS_DB_ATTRIBUTE_BROADCAST) == 0)
+    {
+        EOS_ASSERT(owner_all_cleared(&eos.event[e_id].e_sub));
+    }
+
     /* Write the subscribing information into the object data. */
-    owner_set_bit(&eos.object[index].ocb.event.e_sub,
-                    eos_task_self()->index, true);
+    owner_set_bit(&eos.event[e_id].e_sub, me->index, true);
+
+    /* The new reader of the broadcast stream starts from the newest data. */
+    if (e_type == EOS_EVENT_ATTRIBUTE_STREAM &&
+        (attribute & EOS_DB_ATTRIBUTE_BROADCAST) != 0)
+    {
+        eos_stream_t *queue = eos.event[e_id].data.stream;
+        eos_stream_reader_t *reader = (eos_stream_reader_t *)(queue + 1);
+        reader->cursor[me->index] = queue->head;
+        owner_set_bit(&reader->lagging, me->index, false);
+        eos_db_stream_tail_update_(e_id);
+    }
 
     eos_hw_interrupt_enable(level);
 }
 
+/* The task of the actor object, or null if the known task is not initialized. */
+static inline eos_task_handle_t eos_obj_task_(eos_u16_t t_id)
+{
+    eos_u16_t index = eos.object[t_id].block;
+
+    return (index < EOS_MAX_TASKS) ? eos.tcb[index] : EOS_NULL;
+}
+
 void eos_event_sub(const char *topic)
+{
+    eos_event_sub_(eos_task_self(), eos_topic_get(topic));
+}
+
+void eos_event_sub_h(eos_topic_t topic)
 {
     eos_event_sub_(eos_task_self(), topic);
 }
@@ -1135,33 +1874,62 @@ void eos_event_unsub(const char *topic)
 
     /* Find the matching object by the topic. */
     eos_u16_t index = eos_hash_get_index(EosObj_Event, topic);
-    EOS_ASSERT(index != EosObj_Event);
+    EOS_ASSERT(index != EOS_MAX_OBJECTS);
     EOS_ASSERT(eos.object[index].type == EosObj_Event);
-    EOS_ASSERT((eos.object[index].attribute & 0x03) != EOS_EVENT_ATTRIBUTE_STREAM);
+    /* The buffered value shares the bit with the broadcast stream. */
+    eos_u8_t attribute = eos.object[index].attribute;
+    bool stream = ((attribute & 0x03) == EOS_EVENT_ATTRIBUTE_STREAM);
+    bool broadcast = (stream && (attribute & EOS_DB_ATTRIBUTE_BROADCAST) != 0);
+    EOS_ASSERT(!stream || broadcast);
 
     /* Clear the subscirbe flag. */
-    owner_set_bit(&eos.object[index].ocb.event.e_sub, eos_task_self()->index, false);
+    owner_set_bit(&eos.event[index].e_sub, eos_task_self()->index, false);
+
+    /* The slowest reader of the broadcast stream may be changed. */
+    if (broadcast)
+    {
+        eos_db_stream_tail_update_(index);
+    }
 
     eos_hw_interrupt_enable(level);
 }
 
+#if (EOS_USE_TIME_EVENT != 0)
+/* Remove the timer object, and give its block back to the timer pool. */
+static void eos_timer_block_free_(eos_u16_t tim_id)
+{
+    eos_obj_timer_t *block = &eos.timer[eos.object[tim_id].block];
+    EOS_ASSERT(block->id == tim_id);
+
+    eos_hash_remove(EosObj_Timer, tim_id);
+    eos_timer_detach(&block->timer);
+    block->id = EOS_MAX_OBJECTS;
+}
+
 static void timer_func_timeout(void *parameter)
 {
-    eos_object_t *obj = (eos_object_t *)parameter;
+    eos_obj_timer_t *block = (eos_obj_timer_t *)parameter;
 
-    if (obj->ocb.timer.target != EOS_NULL)
+    if (block->target != EOS_NULL)
     {
-        eos_u16_t t_id = eos.t_id[obj->ocb.timer.target->index];
-        const char *task = eos.object[t_id].key;
-        eos_event_send(task, obj->key);
+        eos_u16_t t_id = eos.t_id[block->target->index];
+        eos_event_send_h(t_id, block->e_id);
     }
     else
     {
-        eos_event_publish(obj->key);
+        eos_event_publish_h(block->e_id);
+    }
+
+    /* The one-shot timer is removed after timeout, so the time event with the
+       same topic can be started again. */
+    if ((eos.object[block->id].attribute & EOS_TIMER_ATTRIBUTE_ONESHOT) != 0)
+    {
+        register eos_base_t level = eos_hw_interrupt_disable();
+        eos_timer_block_free_(block->id);
+        eos_hw_interrupt_enable(level);
     }
 }
 
-#if (EOS_USE_TIME_EVENT != 0)
 static void eos_event_time(const char *task,
                             const char *topic,
                             eos_u32_t time_ms, bool oneshoot)
@@ -1201,17 +1969,34 @@ static void eos_event_time(const char *task,
     eos.object[tim_id].type = EosObj_Timer;
     eos.object[tim_id].attribute = 0;
     eos.object[tim_id].attribute |= EOS_TIMER_ATTRIBUTE_SEND;
+    if (oneshoot)
+    {
+        eos.object[tim_id].attribute |= EOS_TIMER_ATTRIBUTE_ONESHOT;
+    }
+
+    /* Take one free timer block from the pool. */
+    eos_u16_t index = 0;
+    while (index < EOS_MAX_TIMERS && eos.timer[index].id != EOS_MAX_OBJECTS)
+    {
+        index ++;
+    }
+    /* If this assert is trigged, you need to enlarge EOS_MAX_TIMERS. */
+    EOS_ASSERT_NAME(index < EOS_MAX_TIMERS, topic);
+    eos_obj_timer_t *block = &eos.timer[index];
+    eos.object[tim_id].block = index;
+    block->id = tim_id;
+    block->e_id = e_id;
     if (task != EOS_NULL)
     {
-        eos.object[tim_id].ocb.timer.target = eos.object[t_id].ocb.task.tcb;
+        block->target = eos_obj_task_(t_id);
     }
     else
     {
-        eos.object[tim_id].ocb.timer.target = EOS_NULL;
+        block->target = EOS_NULL;
     }
 
     /* Initialize the timer. */
-    eos_timer_t *timer = &eos.object[tim_id].ocb.timer.timer;
+    eos_timer_t *timer = &block->timer;
     eos_u8_t flag_timer;
     if (oneshoot)
     {
@@ -1223,7 +2008,7 @@ static void eos_event_time(const char *task,
     }
     eos_timer_init(timer,
                     timer_func_timeout,
-                    &eos.object[tim_id],
+                    block,
                     time_ms, flag_timer);
     eos_timer_start(timer);
 
@@ -1254,14 +2039,18 @@ void eos_event_send_period(const char *task,
 
 void eos_event_time_cancel(const char *topic)
 {
-    /* Timer ID */
+    register eos_base_t level = eos_hw_interrupt_disable();
+
+    /* The one-shot timer is already removed after timeout, so the cancelling
+       racing with the timeout does nothing. */
     eos_u16_t tim_id = eos_hash_get_index(EosObj_Timer, topic);
-    EOS_ASSERT(tim_id != EOS_MAX_OBJECTS);
+    if (tim_id != EOS_MAX_OBJECTS)
+    {
+        /* Remove the timer, and its object can be used again. */
+        eos_timer_block_free_(tim_id);
+    }
 
-    /* Initialize the timer. */
-    eos_timer_t *timer = &eos.object[tim_id].ocb.timer.timer;
-    eos.object[tim_id].key = EOS_NULL;
-    eos_timer_stop(timer);
+    eos_hw_interrupt_enable(level);
 }
 #endif
 
@@ -1285,6 +2074,49 @@ void eos_db_init(void *const memory, eos_u32_t size)
     eos_heap_init(&eos.db, memory, size);
 }
 
+void eos_db_unregister(const char *key)
+{
+    register eos_base_t level = eos_hw_interrupt_disable();
+
+    eos_u16_t e_id = eos_hash_get_index(EosObj_Event, key);
+    EOS_ASSERT_NAME(e_id != EOS_MAX_OBJECTS, key);
+    eos_u8_t temp8 = EOS_DB_ATTRIBUTE_VALUE | EOS_DB_ATTRIBUTE_STREAM;
+    EOS_ASSERT_NAME((eos.object[e_id].attribute & temp8) != 0, key);
+
+    /* The value and the stream use the same memory pointer. The memory given
+       by the static registry is not freed. */
+    eos_u8_t *data = (eos_u8_t *)eos.event[e_id].data.value;
+    if (data >= (eos_u8_t *)eos.db.data &&
+        data < ((eos_u8_t *)eos.db.data + eos.db.size))
+    {
+        eos_heap_free(&eos.db, data);
+    }
+    eos.event[e_id].data.value = EOS_NULL;
+    eos.object[e_id].size = 0;
+    temp8 |= (EOS_DB_ATTRIBUTE_LOCK_FREE | EOS_DB_ATTRIBUTE_PERSISTENT |
+              EOS_DB_ATTRIBUTE_BROADCAST | EOS_DB_ATTRIBUTE_OVERWRITE);
+    eos.object[e_id].attribute &=~ temp8;
+#if (EOS_USE_DB_PERSIST != 0)
+    eos.persist.save[e_id >> 5] &= ~(1U << (e_id & 31));
+    eos.persist.load[e_id >> 5] &= ~(1U << (e_id & 31));
+#endif
+
+    /* The event object is removed if no task subscribes it, and no event data
+       of it is in any mailbox, or it is kept as a topic-type event. */
+    bool removed = (owner_all_cleared(&eos.event[e_id].e_sub) &&
+                    eos.event[e_id].e_item == EOS_NULL);
+#if (EOS_USE_TOPIC_TABLE != 0)
+    /* The known keys are never removed. */
+    removed = (removed && e_id >= EOS_TOPIC_TABLE_SIZE);
+#endif
+    if (removed)
+    {
+        eos_hash_remove(EosObj_Event, e_id);
+    }
+
+    eos_hw_interrupt_enable(level);
+}
+
 eos_u8_t eos_db_get_attribute(const char *key)
 {
     /* Get event id according the topic. */
@@ -1311,14 +2143,56 @@ void eos_db_set_attribute(const char *key, eos_u8_t attribute)
     eos.object[e_id].attribute = attribute;
 }
 
-void eos_db_register(const char *key, eos_u32_t size, eos_u8_t attribute)
+eos_err_t eos_db_register(const char *key, eos_u32_t size, eos_u8_t attribute)
+{
+    return eos_db_register_(key, size, attribute, EOS_NULL);
+}
+
+/* The memory of the key is given by the static registry, or got from the
+   database heap. */
+static eos_err_t eos_db_register_(const char *key, eos_u32_t size,
+                                  eos_u8_t attribute, void *memory)
 {
     /* Check the argument. */
     eos_u8_t temp8 = EOS_EVENT_ATTRIBUTE_VALUE | EOS_EVENT_ATTRIBUTE_STREAM;
     EOS_ASSERT((attribute & temp8) != temp8);
+    /* The broadcast stream has many readers, and the buffered value has its
+       versions, so neither is lock-free. */
+    EOS_ASSERT((attribute & EOS_DB_ATTRIBUTE_BROADCAST) == 0 ||
+               ((attribute & temp8) != 0 &&
+                (attribute & EOS_DB_ATTRIBUTE_LOCK_FREE) == 0));
+    EOS_ASSERT((attribute & EOS_DB_ATTRIBUTE_OVERWRITE) == 0 ||
+               (attribute & EOS_DB_ATTRIBUTE_BROADCAST) != 0 ||
+               (attribute & EOS_DB_ATTRIBUTE_VALUE) != 0);
+    /* The lock-free value is not compared in writing. */
+    EOS_ASSERT((attribute & EOS_DB_ATTRIBUTE_VALUE) == 0 ||
+               (attribute & EOS_DB_ATTRIBUTE_ON_CHANGE) == 0 ||
+               (attribute & EOS_DB_ATTRIBUTE_LOCK_FREE) == 0);
+    /* Nor is the buffered value, and its versions are found by the size. */
+    EOS_ASSERT((attribute & EOS_DB_ATTRIBUTE_VALUE) == 0 ||
+               (attribute & EOS_DB_ATTRIBUTE_BUFFERED) == 0 ||
+               ((attribute & EOS_DB_ATTRIBUTE_ON_CHANGE) == 0 && size != 0));
+#if (EOS_USE_DB_PERSIST != 0)
+    /* Only the value is saved in the flash, in one record. */
+    EOS_ASSERT((attribute & EOS_DB_ATTRIBUTE_PERSISTENT) == 0 ||
+               ((attribute & EOS_DB_ATTRIBUTE_VALUE) != 0 &&
+                size <= EOS_SIZE_PERSIST_VALUE));
+#endif
+    temp8 = EOS_EVENT_ATTRIBUTE_VALUE | EOS_EVENT_ATTRIBUTE_STREAM;
 
     /* Check the event key's attribute. */
     register eos_base_t level = eos_hw_interrupt_disable();
+#if (EOS_USE_DB_PERSIST != 0)
+    /* The records in the flash are found by the hash value of the key only,
+       so the persistent key with the same hash value as another one is not
+       registered. */
+    if ((attribute & EOS_DB_ATTRIBUTE_PERSISTENT) != 0 &&
+        eos_db_persist_collide_(key))
+    {
+        eos_hw_interrupt_enable(level);
+        return (eos_err_t)EOS_ERROR;
+    }
+#endif
     eos_u16_t e_id = eos_hash_get_index(EosObj_Event, key);
     if (e_id == EOS_MAX_OBJECTS)
     {
@@ -1334,749 +2208,3131 @@ void eos_db_register(const char *key, eos_u32_t size, eos_u8_t attribute)
     eos.object[e_id].attribute = attribute;
     if ((attribute & EOS_DB_ATTRIBUTE_VALUE) != 0)
     {
-        /* Apply a memory for the db key. */
-        void *data = eos_heap_malloc(&eos.db, size);
+        /* Apply a memory for the db key, with the tail after the value. The
+           buffered value has all its versions before the tail, and the
+           bookkeeping of the versions after it. */
+        eos_u32_t size_value = EOS_DB_TAIL_OFFSET(size);
+        eos_u32_t size_tail = sizeof(eos_db_tail_t);
+        if ((attribute & EOS_DB_ATTRIBUTE_BUFFERED) != 0)
+        {
+            size_value *= EOS_DB_VERSIONS;
+            size_tail += sizeof(eos_db_version_t);
+        }
+        void *data = memory;
+        if (data == EOS_NULL)
+        {
+            data = eos_heap_malloc(&eos.db, (size_value + size_tail));
+        }
         EOS_ASSERT(data != EOS_NULL);
 
-        eos.object[e_id].data.value = data;
+        eos.event[e_id].data.value = data;
         eos.object[e_id].size = size;
+        memset(eos_db_tail_(e_id), 0, size_tail);
+        if ((attribute & EOS_DB_ATTRIBUTE_BUFFERED) != 0)
+        {
+            eos_db_version_(e_id)->reserved = EOS_DB_VERSIONS;
+        }
+#if (EOS_USE_DB_PERSIST != 0)
+        /* The key registered after mounting is loaded by the persist task. */
+        if ((attribute & EOS_DB_ATTRIBUTE_PERSISTENT) != 0)
+        {
+            eos_db_persist_mark_(eos.persist.load, e_id);
+        }
+#endif
     }
     else if ((attribute & EOS_DB_ATTRIBUTE_STREAM) != 0)
     {
-        /* Apply a memory for the db key. */
-        void *data = eos_heap_malloc(&eos.db, (size + sizeof(eos_stream_t)));
+        /* Apply a memory for the db key. The broadcast stream has the cursors
+           of its readers in addition. */
+        eos_u32_t size_head = sizeof(eos_stream_t);
+        if ((attribute & EOS_DB_ATTRIBUTE_BROADCAST) != 0)
+        {
+            size_head += sizeof(eos_stream_reader_t);
+        }
+
+        void *data = memory;
+        if (data == EOS_NULL)
+        {
+            data = eos_heap_malloc(&eos.db, (size + size_head));
+        }
         EOS_ASSERT(data != EOS_NULL);
 
-        eos.object[e_id].data.stream = (eos_stream_t *)data;
+        eos.event[e_id].data.stream = (eos_stream_t *)data;
         eos.object[e_id].size = size;
 
-        eos_stream_init(eos.object[e_id].data.stream,
-                        (void *)((eos_u32_t)data + sizeof(eos_stream_t)),
+        eos_stream_init(eos.event[e_id].data.stream,
+                        (void *)((eos_u8_t *)data + size_head),
                         eos.object[e_id].size);
+        memset((eos_u8_t *)data + sizeof(eos_stream_t), 0,
+               size_head - sizeof(eos_stream_t));
 
-        eos_owner_t *e_sub = &eos.object[e_id].ocb.event.e_sub;
+        eos_owner_t *e_sub = &eos.event[e_id].e_sub;
         memset(e_sub, 0, sizeof(eos_owner_t));
     }
 
     eos_hw_interrupt_enable(level);
+
+    return (eos_err_t)EOS_EOK;
 }
 
 void eos_db_block_read(const char *key, void * const data)
 {
-    eos_db_read_(EOS_DB_ATTRIBUTE_VALUE, key, data, 0);
+    eos_db_read_(EOS_DB_ATTRIBUTE_VALUE, key, EOS_MAX_OBJECTS, data, 0);
 }
 
-void eos_db_block_write(const char *key, void * const data)
+void eos_db_block_read_h(eos_topic_t key, void * const data)
 {
-    eos_db_write_(EOS_DB_ATTRIBUTE_VALUE, key, data, 0);
+    eos_db_read_(EOS_DB_ATTRIBUTE_VALUE, EOS_NULL, key, data, 0);
 }
 
-eos_s32_t eos_db_stream_read(const char *key, void *const buffer, eos_u32_t size)
+void eos_db_block_write(const char *key, void * const data)
 {
-    return eos_db_read_(EOS_DB_ATTRIBUTE_STREAM, key, buffer, size);
+    eos_db_write_(EOS_DB_ATTRIBUTE_VALUE, key, EOS_MAX_OBJECTS, data, 0);
 }
 
-void eos_db_stream_write(const char *key, void *const buffer, eos_u32_t size)
+void eos_db_block_write_h(eos_topic_t key, void * const data)
 {
-    eos_db_write_(EOS_DB_ATTRIBUTE_STREAM, key, buffer, size);
+    eos_db_write_(EOS_DB_ATTRIBUTE_VALUE, EOS_NULL, key, data, 0);
 }
 
-/* private db function ------------------------------------------------------ */
-eos_inline void eos_db_write_(eos_u8_t type, const char *key, 
-                                const void *memory, eos_u32_t size)
+void eos_db_write_range(const char *key,
+                        eos_u32_t offset, eos_u32_t size, const void *data)
 {
-    /* If in interrupt service function, disable the interrupt. */
     register eos_base_t level = eos_hw_interrupt_disable();
 
-    /* Get event id according the topic. */
-    eos_u16_t e_id = eos_hash_get_index(EosObj_Event, key);
-    EOS_ASSERT(e_id != EOS_MAX_OBJECTS);
-    EOS_ASSERT(eos.object[e_id].type == EosObj_Event);
-    eos_u8_t attribute = eos.object[e_id].attribute;
-    EOS_ASSERT((attribute & type) != 0);
-    eos_u32_t bits = (1 << eos_task_get_priority(eos_task_self()));
+    eos_u16_t e_id = eos_db_value_get_(key);
+    EOS_ASSERT_NAME((offset + size) <= eos.object[e_id].size, key);
 
-    eos_u32_t size_remain;
-    /* Value type event key. */
-    if (type == EOS_EVENT_ATTRIBUTE_VALUE)
+    /* The lock-free value is copied after the key is found. */
+    if ((eos.object[e_id].attribute & EOS_DB_ATTRIBUTE_LOCK_FREE) != 0)
     {
-        /* Update the event's value. */
-        for (eos_u32_t i = 0; i < eos.object[e_id].size; i++)
-        {
-            ((eos_u8_t *)(eos.object[e_id].data.value))[i] = ((eos_u8_t *)memory)[i];
-        }
+        eos_hw_interrupt_enable(level);
+        eos_db_value_write_(e_id, data, offset, size);
+        return;
     }
-    /* Stream type event key. */
-    else if (type == EOS_EVENT_ATTRIBUTE_STREAM)
+    /* The buffered value is copied into the spare version. */
+    if (eos_db_buffered_(e_id))
     {
-        /* Check if the remaining memory is enough or not. */
-        eos_stream_t *queue = eos.object[e_id].data.stream;
-        size_remain = eos_stream_empty_size(queue);
-        EOS_ASSERT(size_remain >= size);
-        /* Push all data to the queue. */
-        eos_stream_push(queue, (void *)memory, size);
+        eos_hw_interrupt_enable(level);
+        eos_db_version_write_(e_id, data, offset, size);
+        return;
     }
 
+    eos_db_value_update_(e_id, data, offset, size);
+
     eos_hw_interrupt_enable(level);
 }
 
-eos_inline eos_s32_t eos_db_read_(eos_u8_t type,
-                                    const char *key, 
-                                    const void *memory, eos_u32_t size)
+void eos_db_read_range(const char *key,
+                       eos_u32_t offset, eos_u32_t size, void *data)
 {
-    /* If in interrupt service function, disable the interrupt. */
     register eos_base_t level = eos_hw_interrupt_disable();
 
-    /* Get event id according the topic. */
-    eos_u16_t e_id = eos_hash_get_index(EosObj_Event, key);
-    EOS_ASSERT(e_id != EOS_MAX_OBJECTS);
-    EOS_ASSERT(eos.object[e_id].type == EosObj_Event);
-    eos_u8_t attribute = eos.object[e_id].attribute;
-    EOS_ASSERT((attribute & type) != 0);
-    eos_u32_t bits = (1 << eos_task_get_priority(eos_task_self()));
+    eos_u16_t e_id = eos_db_value_get_(key);
+    EOS_ASSERT_NAME((offset + size) <= eos.object[e_id].size, key);
 
-    /* Value type. */
-    eos_s32_t ret_size = 0;
-    if (type == EOS_EVENT_ATTRIBUTE_VALUE)
+    if ((eos.object[e_id].attribute & EOS_DB_ATTRIBUTE_LOCK_FREE) != 0)
     {
-        /* Update the event's value. */
-        for (eos_u32_t i = 0; i < eos.object[e_id].size; i++)
-        {
-            ((eos_u8_t *)memory)[i] =
-                ((eos_u8_t *)(eos.object[e_id].data.value))[i];
-        }
-
-        ret_size = size;
+        eos_hw_interrupt_enable(level);
+        eos_db_value_read_(e_id, data, offset, size);
+        return;
     }
-    /* Stream type. */
-    else if (type == EOS_EVENT_ATTRIBUTE_STREAM)
+    if (eos_db_buffered_(e_id))
     {
-        /* Check if the remaining memory is enough or not. */
-        eos_stream_t *queue = eos.object[e_id].data.stream;
-        /* Push all data to the queue. */
-        ret_size = eos_stream_pull_pop(queue, (void *)memory, size);
+        eos_hw_interrupt_enable(level);
+        eos_db_version_read_(e_id, data, offset, size);
+        return;
     }
 
-    eos_hw_interrupt_enable(level);
+    eos_db_copy_(data, (eos_u8_t *)eos.event[e_id].data.value + offset, size);
 
-    return ret_size;
+    eos_hw_interrupt_enable(level);
 }
 
-/* private sm function ------------------------------------------------------ */
-#if (EOS_USE_SM_MODE != 0)
-eos_ret_t eos_tran(eos_sm_t *const me, eos_state_handler state)
+eos_u32_t eos_db_range_mask(const char *key, eos_u32_t offset, eos_u32_t size)
 {
-    me->state = state;
+    register eos_base_t level = eos_hw_interrupt_disable();
+    eos_u16_t e_id = eos_db_value_get_(key);
+    eos_u32_t mask = eos_db_mask_(eos.object[e_id].size, offset, size);
+    eos_hw_interrupt_enable(level);
 
-    return EOS_Ret_Tran;
+    return mask;
 }
 
-eos_ret_t eos_super(eos_sm_t *const me, eos_state_handler state)
+void eos_db_deadband_s32(const char *key, eos_u32_t band)
 {
-    me->state = state;
+    eos_db_deadband_(key, EosDbBand_S32, band);
+}
 
-    return EOS_Ret_Super;
+void eos_db_deadband_f32(const char *key, float band)
+{
+    eos_u32_t bits;
+    memcpy(&bits, &band, sizeof(bits));
+    eos_db_deadband_(key, EosDbBand_F32, bits);
 }
 
-eos_ret_t eos_state_top(eos_sm_t *const me, eos_event_t const * const e)
+eos_u32_t eos_db_suppressed(const char *key)
 {
-    (void)me;
-    (void)e;
+    register eos_base_t level = eos_hw_interrupt_disable();
+    eos_u32_t suppressed = eos_db_tail_(eos_db_value_get_(key))->suppressed;
+    eos_hw_interrupt_enable(level);
 
-    return EOS_Ret_Null;
+    return suppressed;
 }
-#endif
 
-#if (EOS_USE_SM_MODE != 0)
-static void eos_sm_dispath(eos_sm_t *const me, eos_event_t const * const e)
+const void *eos_db_value_acquire(const char *key)
 {
-#if (EOS_USE_HSM_MODE != 0)
-    eos_state_handler path[EOS_MAX_HSM_NEST_DEPTH];
-#endif
-    eos_ret_t r;
+    register eos_base_t level = eos_hw_interrupt_disable();
 
-    EOS_ASSERT(e != (eos_event_t *)0);
+    eos_u16_t e_id = eos_db_value_get_(key);
+    EOS_ASSERT_NAME(eos_db_buffered_(e_id), key);
+    eos_u32_t index = eos_db_version_acquire_(e_id);
+    const void *data = eos_db_version_data_(e_id, index);
 
-#if (EOS_USE_HSM_MODE == 0)
-    eos_state_handler s = me->state;
-    eos_state_handler t;
-    
-    r = s(me, e);
-    if (r == EOS_Ret_Tran)
-    {
-        t = me->state;
-        r = s(me, &eos_event_table[Event_Exit]);
-        EOS_ASSERT(r == EOS_Ret_Handled || r == EOS_Ret_Super);
-        r = t(me, &eos_event_table[Event_Enter]);
-        EOS_ASSERT(r == EOS_Ret_Handled || r == EOS_Ret_Super);
-        me->state = t;
-    }
-    else
-    {
-        me->state = s;
-    }
-#else
-    eos_state_handler t = me->state;
-    eos_state_handler s;
+    eos_hw_interrupt_enable(level);
 
-    do {
-        s = me->state;
-        r = (*s)(me, e);
-    } while (r == EOS_Ret_Super);
+    return data;
+}
 
-    if (r != EOS_Ret_Tran)
-    {
-        me->state = t;
-        return;
-    }
+void eos_db_value_release(const char *key, const void *data)
+{
+    register eos_base_t level = eos_hw_interrupt_disable();
 
-    path[0] = me->state;
-    path[1] = t;
-    path[2] = s;
+    eos_u16_t e_id = eos_db_value_get_(key);
+    EOS_ASSERT_NAME(eos_db_buffered_(e_id), key);
+    eos_db_version_release_(e_id, eos_db_version_index_(e_id, data));
 
-    /* exit current state to transition source s... */
-    while (t != s)
-    {
-        /* exit handled? */
-        if (HSM_TRIG_(t, Event_Exit) == EOS_Ret_Handled)
-        {
-            (void)HSM_TRIG_(t, Event_Null); /* find superstate of t */
-        }
-        t = me->state; /* stateTgt_ holds the superstate */
-    }
+    eos_hw_interrupt_enable(level);
+}
 
-    eos_s32_t ip = eos_sm_tran(me, path); /* take the HSM transition */
+void *eos_db_value_reserve(const char *key)
+{
+    register eos_base_t level = eos_hw_interrupt_disable();
+    eos_u16_t e_id = eos_db_value_get_(key);
+    EOS_ASSERT_NAME(eos_db_buffered_(e_id), key);
+    eos_hw_interrupt_enable(level);
 
-    /* retrace the entry path in reverse (desired) order... */
-    for (; ip >= 0; --ip)
-    {
-        HSM_TRIG_(path[ip], Event_Enter); /* enter path[ip] */
-    }
-    t = path[0];    /* stick the target into register */
-    me->state = t; /* update the next state */
+    return eos_db_version_data_(e_id, eos_db_version_reserve_(e_id));
+}
 
-    while (HSM_TRIG_(t, Event_Init) == EOS_Ret_Tran)
-    {
-        ip = 0;
-        path[0] = me->state;
-        (void)HSM_TRIG_(me->state, Event_Null);
-        while (me->state != t)
-        {
-            ip++;
-            path[ip] = me->state;
-            (void)HSM_TRIG_(me->state, Event_Null);
-        }
-        me->state = path[0];
+void eos_db_value_commit(const char *key, void *data)
+{
+    register eos_base_t level = eos_hw_interrupt_disable();
+    eos_u16_t e_id = eos_db_value_get_(key);
+    EOS_ASSERT_NAME(eos_db_buffered_(e_id), key);
+    eos_u32_t index = eos_db_version_index_(e_id, data);
+    eos_hw_interrupt_enable(level);
 
-        EOS_ASSERT(ip < EOS_MAX_HSM_NEST_DEPTH);
+    eos_db_version_commit_(e_id, index,
+                           eos_db_mask_(eos.object[e_id].size,
+                                        0, eos.object[e_id].size));
+}
 
-        /* retrace the entry path in reverse (correct) order... */
-        do {
-            HSM_TRIG_(path[ip --], Event_Enter);
-        } while (ip >= 0);
+eos_s32_t eos_db_stream_read(const char *key, void *const buffer, eos_u32_t size)
+{
+    return eos_db_read_(EOS_DB_ATTRIBUTE_STREAM,
+                        key, EOS_MAX_OBJECTS, buffer, size);
+}
 
-        t = path[0];
-    }
+void eos_db_stream_write(const char *key, void *const buffer, eos_u32_t size)
+{
+    eos_db_write_(EOS_DB_ATTRIBUTE_STREAM, key, EOS_MAX_OBJECTS, buffer, size);
+}
 
-    me->state = t;
-#endif
+eos_s32_t eos_db_stream_read_h(eos_topic_t key,
+                               void *const buffer, eos_u32_t size)
+{
+    return eos_db_read_(EOS_DB_ATTRIBUTE_STREAM, EOS_NULL, key, buffer, size);
 }
 
-#if (EOS_USE_HSM_MODE != 0)
-static eos_s32_t eos_sm_tran(eos_sm_t *const me,
-                           eos_state_handler path[EOS_MAX_HSM_NEST_DEPTH])
+void eos_db_stream_write_h(eos_topic_t key, void *const buffer, eos_u32_t size)
 {
-    /* transition entry path index */
-    eos_s32_t ip = -1;
-    eos_s32_t iq; /* helper transition entry path index */
-    eos_state_handler t = path[0];
-    eos_state_handler s = path[2];
-    eos_ret_t r;
+    eos_db_write_(EOS_DB_ATTRIBUTE_STREAM, EOS_NULL, key, buffer, size);
+}
 
-    /* (a) 跳转到自身 s == t */
-    if (s == t)
-    {
-        HSM_TRIG_(s, Event_Exit);  /* exit the source */
-        return 0; /* cause entering the target */
-    }
+bool eos_db_stream_lagging(const char *key)
+{
+    register eos_base_t level = eos_hw_interrupt_disable();
 
-    (void)HSM_TRIG_(t, Event_Null); /* superstate of target */
-    t = me->state;
+    eos_stream_t *queue = eos_db_stream_get_(key);
+    eos_u16_t e_id = eos_hash_get_index(EosObj_Event, key);
+    EOS_ASSERT_NAME((eos.object[e_id].attribute &
+                     EOS_DB_ATTRIBUTE_BROADCAST) != 0, key);
+    eos_stream_reader_t *reader = (eos_stream_reader_t *)(queue + 1);
+    eos_u16_t t_index = eos_task_self()->index;
+    bool lagging = owner_is_occupied(&reader->lagging, t_index);
+    owner_set_bit(&reader->lagging, t_index, false);
 
-    /* (b) check source == target->super */
-    if (s == t)
-        return 0; /* cause entering the target */
+    eos_hw_interrupt_enable(level);
 
-    (void)HSM_TRIG_(s, Event_Null); /* superstate of src */
+    return lagging;
+}
 
-    /* (c) check source->super == target->super */
-    if (me->state == t)
-    {
-        HSM_TRIG_(s, Event_Exit);  /* exit the source */
-        return 0; /* cause entering the target */
-    }
+eos_u32_t eos_db_stream_dropped(const char *key)
+{
+    register eos_base_t level = eos_hw_interrupt_disable();
+    eos_u32_t dropped = eos_db_stream_get_(key)->dropped;
+    eos_hw_interrupt_enable(level);
 
-    /* (d) check source->super == target */
-    if (me->state == path[0])
+    return dropped;
+}
+
+eos_u32_t eos_db_stream_reserve(const char *key,
+                                eos_u32_t min, eos_db_span_t * const span)
+{
+    register eos_base_t level = eos_hw_interrupt_disable();
+
+    eos_stream_t *queue = eos_db_stream_get_(key);
+    eos_u32_t size = eos_stream_empty_size(queue);
+    if (size < min || size == 0)
     {
-        HSM_TRIG_(s, Event_Exit); /* exit the source */
-        return -1;
+        size = 0;
+        span->size[0] = 0;
+        span->size[1] = 0;
+    }
+    else
+    {
+        eos_stream_span(queue, queue->head, size, span);
     }
 
-    /* (e) check rest of source == target->super->super.. */
-    /* and store the entry path along the way */
+    eos_hw_interrupt_enable(level);
 
-    /* indicate that the LCA was not found */
-    iq = 0;
+    return size;
+}
 
-    /* enter target and its superstate */
-    ip = 1;
-    path[1] = t; /* save the superstate of target */
-    t = me->state; /* save source->super */
+void eos_db_stream_commit(const char *key, eos_u32_t size)
+{
+    register eos_base_t level = eos_hw_interrupt_disable();
 
-    /* find target->super->super */
-    r = HSM_TRIG_(path[1], Event_Null);
-    while (r == EOS_Ret_Super)
+    eos_stream_t *queue = eos_db_stream_get_(key);
+    /* If this assert is trigged, more bytes are committed than reserved. */
+    EOS_ASSERT_NAME(size <= (eos_u32_t)eos_stream_empty_size(queue), key);
+    EOS_MEMORY_BARRIER();
+    queue->head = stream_forward(queue, queue->head, size);
+    /* The broadcast stream keeps no data without any reader. */
+    eos_u16_t e_id = eos_hash_get_index(EosObj_Event, key);
+    if ((eos.object[e_id].attribute & EOS_DB_ATTRIBUTE_BROADCAST) != 0 &&
+        owner_all_cleared(&eos.event[e_id].e_sub))
     {
-       ++ ip;
-        path[ip] = me->state; /* store the entry path */
-        if (me->state == s)
-        { /* is it the source? */
-            /* indicate that the LCA was found */
-            iq = 1;
-
-            /* entry path must not overflow */
-            EOS_ASSERT(ip < EOS_MAX_HSM_NEST_DEPTH);
-            --ip;  /* do not enter the source */
-            r = EOS_Ret_Handled; /* terminate the loop */
-        }
-        /* it is not the source, keep going up */
-        else
-            r = HSM_TRIG_(me->state, Event_Null);
+        queue->tail = queue->head;
     }
+    eos_db_stream_wake_(e_id);
 
-    /* LCA found yet? */
-    if (iq == 0)
+    eos_hw_interrupt_enable(level);
+}
+
+eos_u32_t eos_db_stream_peek(const char *key, eos_db_span_t * const span)
+{
+    register eos_base_t level = eos_hw_interrupt_disable();
+
+    eos_stream_t *queue = eos_db_stream_get_(key);
+    volatile eos_u32_t *cursor =
+        eos_db_stream_cursor_(eos_hash_get_index(EosObj_Event, key));
+    eos_u32_t size = eos_stream_span(queue, *cursor,
+                                     stream_used(queue, queue->head, *cursor),
+                                     span);
+
+    eos_hw_interrupt_enable(level);
+
+    return size;
+}
+
+void eos_db_stream_release(const char *key, eos_u32_t size)
+{
+    register eos_base_t level = eos_hw_interrupt_disable();
+
+    eos_stream_t *queue = eos_db_stream_get_(key);
+    eos_u16_t e_id = eos_hash_get_index(EosObj_Event, key);
+    volatile eos_u32_t *cursor = eos_db_stream_cursor_(e_id);
+    /* If this assert is trigged, more bytes are released than peeked. */
+    EOS_ASSERT_NAME(size <= stream_used(queue, queue->head, *cursor), key);
+    EOS_MEMORY_BARRIER();
+    *cursor = stream_forward(queue, *cursor, size);
+    eos_db_stream_tail_update_(e_id);
+    eos_db_stream_wake_(e_id);
+
+    eos_hw_interrupt_enable(level);
+}
+
+void eos_db_stream_watermark(const char *key,
+                             eos_u32_t level_high, eos_u32_t level_low)
+{
+    register eos_base_t level = eos_hw_interrupt_disable();
+
+    eos_stream_t *queue = eos_db_stream_get_(key);
+    EOS_ASSERT_NAME(level_high != 0 && level_high <= queue->capacity, key);
+    EOS_ASSERT_NAME(level_low <= queue->capacity, key);
+    queue->level_high = level_high;
+    queue->level_low = level_low;
+
+    eos_hw_interrupt_enable(level);
+}
+
+eos_s32_t eos_db_stream_read_wait(const char *key, void *const buffer,
+                                  eos_u32_t size, eos_s32_t time_ms)
+{
+    eos_task_handle_t task = eos_task_self();
+    eos_u32_t time_start = eos_tick_get_ms();
+    eos_s32_t time_wait = time_ms;
+    eos_s32_t ret_size;
+    register eos_base_t level;
+
+    while (1)
     {
-        /* entry path must not overflow */
-        EOS_ASSERT(ip < EOS_MAX_HSM_NEST_DEPTH);
+        level = eos_hw_interrupt_disable();
+
+        eos_stream_t *queue = eos_db_stream_get_(key);
+        eos_u16_t e_id = eos_hash_get_index(EosObj_Event, key);
+        EOS_ASSERT_NAME((eos.object[e_id].attribute &
+                         EOS_DB_ATTRIBUTE_LOCK_FREE) == 0, key);
+        volatile eos_u32_t *cursor = eos_db_stream_cursor_(e_id);
+        if (stream_used(queue, queue->head, *cursor) >= queue->level_high)
+        {
+            owner_set_bit(&queue->t_read, task->index, false);
+            ret_size = eos_db_read_(EOS_DB_ATTRIBUTE_STREAM,
+                                    key, EOS_MAX_OBJECTS, buffer, size);
+            eos_hw_interrupt_enable(level);
 
-        HSM_TRIG_(s, Event_Exit); /* exit the source */
+            return ret_size;
+        }
 
-        /* (f) check the rest of source->super */
-        /*                  == target->super->super... */
-        iq = ip;
-        r = EOS_Ret_Null; /* indicate LCA NOT found */
-        do {
-            /* is this the LCA? */
-            if (t == path[iq])
+        /* The writers wake up this task at the high watermark. */
+        owner_set_bit(&queue->t_read, task->index, true);
+        eos_hw_interrupt_enable(level);
+
+        if (time_ms > 0)
+        {
+            time_wait = time_ms - (eos_s32_t)(eos_tick_get_ms() - time_start);
+            if (time_wait < 0)
             {
-                r = EOS_Ret_Handled; /* indicate LCA found */
-                /* do not enter LCA */
-                ip = iq - 1;
-                /* cause termination of the loop */
-                iq = -1;
+                time_wait = 0;
             }
-            else
-                -- iq; /* try lower superstate of target */
-        } while (iq >= 0);
+        }
 
-        /* LCA not found yet? */
-        if (r != EOS_Ret_Handled)
+        if (eos_sem_take(&task->sem, time_wait) != EOS_EOK)
         {
-            /* (g) check each source->super->... */
-            /* for each target->super... */
-            r = EOS_Ret_Null; /* keep looping */
-            do {
-                /* exit t unhandled? */
-                if (HSM_TRIG_(t, Event_Exit) == EOS_Ret_Handled)
-                {
-                    (void)HSM_TRIG_(t, Event_Null);
-                }
-                t = me->state; /*  set to super of t */
-                iq = ip;
-                do {
-                    /* is this LCA? */
-                    if (t == path[iq])
-                    {
-                        /* do not enter LCA */
-                        ip = iq - 1;
-                        /* break out of inner loop */
-                        iq = -1;
-                        r = EOS_Ret_Handled; /* break outer loop */
-                    }
-                    else
-                        --iq;
-                } while (iq >= 0);
-            } while (r != EOS_Ret_Handled);
+            /* The data below the high watermark is read at the timeout. */
+            level = eos_hw_interrupt_disable();
+            owner_set_bit(&eos_db_stream_get_(key)->t_read, task->index, false);
+            ret_size = eos_db_read_(EOS_DB_ATTRIBUTE_STREAM,
+                                    key, EOS_MAX_OBJECTS, buffer, size);
+            eos_hw_interrupt_enable(level);
+
+            return ret_size;
         }
     }
-
-    return ip;
 }
-#endif
-#endif
 
-/* private heap function ---------------------------------------------------- */
-void eos_heap_init(eos_heap_t *const me, void *data, eos_u32_t size)
+bool eos_db_stream_write_wait(const char *key, void *const buffer,
+                              eos_u32_t size, eos_s32_t time_ms)
 {
-    EOS_ASSERT(data != EOS_NULL);
-    EOS_ASSERT(size > sizeof(eos_heap_block_t));
+    eos_task_handle_t task = eos_task_self();
+    eos_u32_t time_start = eos_tick_get_ms();
+    eos_s32_t time_wait = time_ms;
+    register eos_base_t level;
 
-    eos_u32_t mod = ((eos_u32_t)data % 4);
-    if (mod != 0)
+    while (1)
     {
-        data = (void *)((eos_u32_t)data + 4 - mod);
-        size = size - 4;
-    }
-    
-    /* block start */
-    me->data = data;
-    me->list = (eos_heap_block_t *)me->data;
-    me->size = size;
-    me->error_id = 0;
+        level = eos_hw_interrupt_disable();
+
+        eos_stream_t *queue = eos_db_stream_get_(key);
+        eos_u8_t attribute =
+            eos.object[eos_hash_get_index(EosObj_Event, key)].attribute;
+        EOS_ASSERT_NAME((attribute & EOS_DB_ATTRIBUTE_LOCK_FREE) == 0, key);
+        EOS_ASSERT_NAME(size <= queue->capacity, key);
+        if ((eos_u32_t)eos_stream_empty_size(queue) >= size ||
+            (attribute & EOS_DB_ATTRIBUTE_OVERWRITE) != 0)
+        {
+            owner_set_bit(&queue->t_write, task->index, false);
+            eos_db_write_(EOS_DB_ATTRIBUTE_STREAM,
+                          key, EOS_MAX_OBJECTS, buffer, size);
+            eos_hw_interrupt_enable(level);
 
-    /* the 1st free block */
-    eos_heap_block_t *block_1st;
-    block_1st = (eos_heap_block_t *)me->data;
-    block_1st->next = EOS_NULL;
-    block_1st->size = size - (eos_u32_t)sizeof(eos_heap_block_t);
-    block_1st->is_free = 1;
+            return true;
+        }
+
+        /* The readers wake up this task at the low watermark. */
+        owner_set_bit(&queue->t_write, task->index, true);
+        eos_hw_interrupt_enable(level);
+
+        if (time_ms > 0)
+        {
+            time_wait = time_ms - (eos_s32_t)(eos_tick_get_ms() - time_start);
+            if (time_wait < 0)
+            {
+                time_wait = 0;
+            }
+        }
+
+        if (eos_sem_take(&task->sem, time_wait) != EOS_EOK)
+        {
+            level = eos_hw_interrupt_disable();
+            owner_set_bit(&eos_db_stream_get_(key)->t_write, task->index, false);
+            eos_hw_interrupt_enable(level);
+
+            return false;
+        }
+    }
 }
 
-void * eos_heap_malloc(eos_heap_t *const me, eos_u32_t size)
+#if (EOS_USE_DB_PERSIST != 0)
+static ek_task_t persist_task;
+static eos_u32_t persist_task_stack[EOS_PERSIST_TASK_STACK_SIZE / 4];
+
+/* The index is built from the headers of all the records, from the oldest
+   sector to the newest one, without reading any value. The values are only
+   checked when they are loaded or moved. */
+void eos_db_persist_mount(const eos_flash_t *flash)
 {
-    eos_heap_block_t *block;
-    
-    if (size == 0)
+    eos_persist_t *me = &eos.persist;
+
+    EOS_ASSERT(me->flash == EOS_NULL);
+    EOS_ASSERT(flash->sector_count >= 3);
+    EOS_ASSERT(flash->align >= 4 && flash->align <= EOS_PERSIST_CHUNK &&
+               (flash->align & (flash->align - 1)) == 0);
+    EOS_ASSERT((flash->sector_size % EOS_PERSIST_CHUNK) == 0);
+
+    me->flash = flash;
+    me->count = 0;
+    me->signaled = false;
+    me->flush = false;
+    me->busy = false;
+    memset(&me->info, 0, sizeof(eos_db_persist_info_t));
+    eos_sem_init(&me->sem, 0);
+
+    /* The biggest record fits in one sector with its header. */
+    EOS_ASSERT((persist_align(sizeof(eos_persist_sector_t)) +
+                persist_align(sizeof(eos_persist_record_t)) +
+                persist_align(EOS_SIZE_PERSIST_VALUE)) <= flash->sector_size);
+
+    /* The newest sector is the head. */
+    bool found = false;
+    for (eos_u16_t i = 0; i < flash->sector_count; i ++)
     {
-        me->error_id = 1;
-        return EOS_NULL;
+        eos_persist_sector_t header;
+        persist_read(i * flash->sector_size, &header, sizeof(header));
+        if (header.magic == EOS_PERSIST_MAGIC_SECTOR &&
+            (found == false || (eos_s32_t)(header.seq - me->seq) > 0))
+        {
+            me->head = i;
+            me->seq = header.seq;
+            found = true;
+        }
     }
 
-    eos_u32_t mod = (size % 4);
-    if (mod != 0)
+    /* The blank or unknown flash is formatted from the first sector. */
+    if (found == false)
     {
-        size = size + 4 - mod;
+        me->head = 0;
+        me->seq = 0;
+        persist_sector_open(0);
     }
-
-    /* Find the first free block in the block-list. */
-    block = (eos_heap_block_t *)me->list;
-    do
+    else
     {
-        if (block->is_free == 1 &&
-            block->size > (size + sizeof(eos_heap_block_t)))
+        for (eos_u16_t i = 1; i <= flash->sector_count; i ++)
         {
-            break;
+            eos_u16_t sector = (me->head + i) % flash->sector_count;
+            if (persist_sector_used(sector))
+            {
+                eos_u32_t offset =
+                    persist_sector_walk(sector, PersistWalk_Index, EOS_NULL);
+                if (sector == me->head)
+                {
+                    me->offset = offset;
+                }
+            }
         }
-        else
+
+        /* The collecting of the oldest sector was cut by a power loss. */
+        eos_u16_t oldest = (me->head + 1) % flash->sector_count;
+        if (persist_sector_used(oldest))
         {
-            block = block->next;
+            persist_collect(oldest, PersistWalk_Resume);
         }
-    } while (block != EOS_NULL);
 
-    if (block == EOS_NULL)
-    {
-        me->error_id = 2;
-        return EOS_NULL;
+        /* The records in the head may be cut by a power loss. The broken one
+           is replaced by a copy of the good one before it, so the newest
+           record of every key out of the head is always good. */
+        eos_u16_t i = 0;
+        while (i < me->count)
+        {
+            eos_persist_entry_t *entry = &me->entry[i];
+            eos_persist_record_t record;
+            if ((entry->addr / flash->sector_size) != me->head ||
+                persist_check(entry->addr, &record))
+            {
+                i ++;
+            }
+            else if (persist_recover(entry))
+            {
+                persist_check(entry->addr, &record);
+                persist_append(record.hash, EOS_NULL, record.size);
+            }
+        }
     }
 
-    /* If the block's byte number is NOT enough to create a new block. */
-    if (block->size <= (eos_u32_t)((eos_u32_t)size + sizeof(eos_heap_block_t)))
+    /* The keys registered before mounting get their saved values. */
+    for (eos_u16_t e_id = 0; e_id < EOS_MAX_OBJECTS; e_id ++)
     {
-        block->is_free = 0;
+        if (eos.object[e_id].key != EOS_NULL &&
+            eos.object[e_id].type == EosObj_Event &&
+            (eos.object[e_id].attribute & EOS_DB_ATTRIBUTE_VALUE) != 0 &&
+            (eos.object[e_id].attribute & EOS_DB_ATTRIBUTE_PERSISTENT) != 0)
+        {
+            persist_load(e_id);
+        }
     }
-    /* Divide the block into two blocks. */
-    else
+
+    ek_task_init(&persist_task,
+                 eos_persist_task_entry,
+                 EOS_NULL,
+                 &persist_task_stack[0],
+                 sizeof(persist_task_stack),
+                 EOS_PERSIST_TASK_PRIO,
+                 EOS_TIMESLICE);
+    eos_task_startup((eos_task_handle_t)&persist_task);
+}
+
+void eos_db_persist_flush(void)
+{
+    eos_persist_t *me = &eos.persist;
+    EOS_ASSERT(me->flash != EOS_NULL);
+    /* If this assert is trigged, flush the keys in one task. */
+    EOS_ASSERT(eos_interrupt_get_nest() == 0);
+
+    register eos_base_t level = eos_hw_interrupt_disable();
+    me->flush = true;
+    bool signal = (me->signaled == false);
+    me->signaled = true;
+    eos_hw_interrupt_enable(level);
+    if (signal == true)
     {
-        eos_heap_block_t *new_block
-            = (eos_heap_block_t *)((eos_u32_t)block + size + sizeof(eos_heap_block_t));
-        new_block->size = block->size - size - sizeof(eos_heap_block_t);
-        new_block->is_free = 1;
-        new_block->next = EOS_NULL;
+        eos_sem_release(&me->sem);
+    }
 
-        /* Update the list. */
-        new_block->next = block->next;
-        block->next = new_block;
-        block->size = size;
-        block->is_free = 0;
+    while (1)
+    {
+        bool pending = me->busy;
+        level = eos_hw_interrupt_disable();
+        for (eos_u32_t i = 0; i < ((EOS_MAX_OBJECTS + 31) >> 5); i ++)
+        {
+            if ((me->save[i] | me->load[i]) != 0)
+            {
+                pending = true;
+            }
+        }
+        eos_hw_interrupt_enable(level);
+        if (pending == false)
+        {
+            break;
+        }
+        eos_task_delay(1);
     }
+}
 
-    me->error_id = 0;
+void eos_db_persist_info(eos_db_persist_info_t * const info)
+{
+    register eos_base_t level = eos_hw_interrupt_disable();
+    *info = eos.persist.info;
+    eos_hw_interrupt_enable(level);
+}
+#endif
+
+/* private db function ------------------------------------------------------ */
+static eos_stream_t *eos_db_stream_get_(const char *key)
+{
+    eos_u16_t e_id = eos_hash_get_index(EosObj_Event, key);
+    EOS_ASSERT_NAME(e_id < EOS_MAX_OBJECTS, key);
+    EOS_ASSERT(eos.object[e_id].type == EosObj_Event);
+    EOS_ASSERT_NAME((eos.object[e_id].attribute & EOS_DB_ATTRIBUTE_STREAM) != 0,
+                    key);
+
+    return eos.event[e_id].data.stream;
+}
+
+/* The read index of the current task, the cursor of the broadcast stream, or
+   the tail of the other one. */
+static volatile eos_u32_t *eos_db_stream_cursor_(eos_u16_t e_id)
+{
+    eos_stream_t *queue = eos.event[e_id].data.stream;
+    if ((eos.object[e_id].attribute & EOS_DB_ATTRIBUTE_BROADCAST) == 0)
+    {
+        return &queue->tail;
+    }
+
+    /* If this assert is trigged, the task does not subscribe the stream. */
+    eos_u16_t t_index = eos_task_self()->index;
+    EOS_ASSERT_NAME(owner_is_occupied(&eos.event[e_id].e_sub, t_index),
+                    eos.object[e_id].key);
+
+    return &((eos_stream_reader_t *)(queue + 1))->cursor[t_index];
+}
+
+/* The tail of the broadcast stream follows the slowest reader. Without any
+   reader, the data is not kept. */
+static void eos_db_stream_tail_update_(eos_u16_t e_id)
+{
+    eos_stream_t *queue = eos.event[e_id].data.stream;
+    eos_stream_reader_t *reader = (eos_stream_reader_t *)(queue + 1);
+    eos_u32_t head = queue->head;
+    eos_u32_t tail = head;
+    eos_u32_t size_max = 0;
+
+    for (eos_u32_t i = 0; i < EOS_MAX_OWNER; i++)
+    {
+        eos_u32_t bits = eos.event[e_id].e_sub.data[i];
+        while (bits != 0)
+        {
+            eos_u16_t t_index = (i << 5) + __eos_ffs((int)bits) - 1;
+            bits &= (bits - 1);
+
+            eos_u32_t size = stream_used(queue, head, reader->cursor[t_index]);
+            if (size > size_max)
+            {
+                size_max = size;
+                tail = reader->cursor[t_index];
+            }
+        }
+    }
+
+    queue->tail = tail;
+}
+
+/* Make room for size bytes, by moving the readers behind forward. They lose
+   the oldest data, and are flagged. */
+static void eos_db_stream_overwrite_(eos_u16_t e_id, eos_u32_t size)
+{
+    eos_stream_t *queue = eos.event[e_id].data.stream;
+    eos_stream_reader_t *reader = (eos_stream_reader_t *)(queue + 1);
+    eos_u32_t head = queue->head;
+    eos_u32_t size_keep = queue->capacity - size;
+
+    for (eos_u32_t i = 0; i < EOS_MAX_OWNER; i++)
+    {
+        eos_u32_t bits = eos.event[e_id].e_sub.data[i];
+        while (bits != 0)
+        {
+            eos_u16_t t_index = (i << 5) + __eos_ffs((int)bits) - 1;
+            bits &= (bits - 1);
+
+            eos_u32_t *cursor = &reader->cursor[t_index];
+            eos_u32_t size_used = stream_used(queue, head, *cursor);
+            if (size_used > size_keep)
+            {
+                *cursor = stream_forward(queue, *cursor, size_used - size_keep);
+                owner_set_bit(&reader->lagging, t_index, true);
+            }
+        }
+    }
+
+    eos_db_stream_tail_update_(e_id);
+}
+
+/* Wake up the tasks waiting for the stream, the readers when their data reaches
+   the high watermark, and the writers when the data falls to the low one. The
+   woken task checks the stream again. */
+static void eos_db_stream_wake_(eos_u16_t e_id)
+{
+    eos_stream_t *queue = eos.event[e_id].data.stream;
+    bool broadcast =
+        ((eos.object[e_id].attribute & EOS_DB_ATTRIBUTE_BROADCAST) != 0);
+    eos_stream_reader_t *reader = (eos_stream_reader_t *)(queue + 1);
+    eos_u32_t head = queue->head;
+    bool space = (stream_used(queue, head, queue->tail) <= queue->level_low);
+
+    for (eos_u32_t i = 0; i < EOS_MAX_OWNER; i++)
+    {
+        eos_u32_t bits = queue->t_read.data[i];
+        if (space)
+        {
+            bits |= queue->t_write.data[i];
+            queue->t_write.data[i] = 0;
+        }
+        while (bits != 0)
+        {
+            eos_u16_t t_index = (i << 5) + __eos_ffs((int)bits) - 1;
+            bits &= (bits - 1);
+
+            if (owner_is_occupied(&queue->t_read, t_index))
+            {
+                eos_u32_t tail = broadcast ? reader->cursor[t_index] :
+                                             queue->tail;
+                if (stream_used(queue, head, tail) < queue->level_high)
+                {
+                    continue;
+                }
+                owner_set_bit(&queue->t_read, t_index, false);
+            }
+            eos_sem_release(&eos.tcb[t_index]->sem);
+        }
+    }
+}
+
+/* Copy the value by words if both sides are aligned. The volatile access
+   keeps the copy of the lock-free value in the order of the code. */
+static void eos_db_copy_(void *dst, const void *src, eos_u32_t size)
+{
+    eos_u32_t i = 0;
+    if ((((size_t)dst | (size_t)src) & 3) == 0)
+    {
+        for (; (i + 4) <= size; i += 4)
+        {
+            *(volatile eos_u32_t *)((eos_u8_t *)dst + i) =
+                *(volatile const eos_u32_t *)((const eos_u8_t *)src + i);
+        }
+    }
+    for (; i < size; i ++)
+    {
+        ((volatile eos_u8_t *)dst)[i] = ((volatile const eos_u8_t *)src)[i];
+    }
+}
+
+static inline eos_db_tail_t *eos_db_tail_(eos_u16_t e_id)
+{
+    eos_u32_t offset = EOS_DB_TAIL_OFFSET(eos.object[e_id].size);
+    if (eos_db_buffered_(e_id))
+    {
+        offset *= EOS_DB_VERSIONS;
+    }
+
+    return (eos_db_tail_t *)((eos_u8_t *)eos.event[e_id].data.value + offset);
+}
+
+static eos_u16_t eos_db_value_get_(const char *key)
+{
+    eos_u16_t e_id = eos_hash_get_index(EosObj_Event, key);
+    EOS_ASSERT_NAME(e_id < EOS_MAX_OBJECTS, key);
+    EOS_ASSERT(eos.object[e_id].type == EosObj_Event);
+    EOS_ASSERT_NAME((eos.object[e_id].attribute & EOS_DB_ATTRIBUTE_VALUE) != 0,
+                    key);
+
+    return e_id;
+}
+
+/* Every bit of the dirty mask is for one region of the value. The value is cut
+   into 32 regions at most, and every region is in words. */
+static eos_u32_t eos_db_mask_(eos_u32_t size, eos_u32_t offset, eos_u32_t len)
+{
+    if (len == 0)
+    {
+        return 0;
+    }
+
+    eos_u32_t size_region = (((size + 31) >> 5) + 3) & ~3U;
+    eos_u32_t first = offset / size_region;
+    eos_u32_t last = (offset + len - 1) / size_region;
+    eos_u32_t mask = (last >= 31) ? 0xFFFFFFFFU : ((1U << (last + 1)) - 1);
+
+    return (mask & ~((1U << first) - 1));
+}
+
+/* The value is compared in bytes, or in numbers with the deadband. */
+static bool eos_db_changed_(eos_u16_t e_id, const void *memory,
+                            eos_u32_t offset, eos_u32_t size)
+{
+    eos_db_tail_t *tail = eos_db_tail_(e_id);
+    const eos_u8_t *value = (eos_u8_t *)eos.event[e_id].data.value + offset;
+    if (tail->band_type == EosDbBand_None)
+    {
+        return (memcmp(value, memory, size) != 0);
+    }
+
+    /* If this assert is trigged, the range is not made of whole numbers. */
+    EOS_ASSERT(((offset | size) & 3) == 0);
+    for (eos_u32_t i = 0; i < size; i += 4)
+    {
+        if (tail->band_type == EosDbBand_S32)
+        {
+            eos_s32_t value_old, value_new;
+            memcpy(&value_old, &value[i], 4);
+            memcpy(&value_new, (const eos_u8_t *)memory + i, 4);
+            eos_u32_t diff = (value_new > value_old) ?
+                             ((eos_u32_t)value_new - (eos_u32_t)value_old) :
+                             ((eos_u32_t)value_old - (eos_u32_t)value_new);
+            if (diff > tail->band)
+            {
+                return true;
+            }
+        }
+        else
+        {
+            float value_old, value_new, band;
+            memcpy(&value_old, &value[i], 4);
+            memcpy(&value_new, (const eos_u8_t *)memory + i, 4);
+            memcpy(&band, &tail->band, 4);
+            float diff = value_new - value_old;
+            /* NaN is never within the deadband. */
+            if (!(diff <= band && diff >= -band))
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/* The unchanged value of the key with EOS_DB_ATTRIBUTE_ON_CHANGE is not
+   written, so it keeps the last value out of the deadband, and its regions are
+   not dirty. */
+static void eos_db_value_update_(eos_u16_t e_id, const void *memory,
+                                 eos_u32_t offset, eos_u32_t size)
+{
+    eos_db_tail_t *tail = eos_db_tail_(e_id);
+    if ((eos.object[e_id].attribute & EOS_DB_ATTRIBUTE_ON_CHANGE) != 0 &&
+        !eos_db_changed_(e_id, memory, offset, size))
+    {
+        tail->suppressed ++;
+        return;
+    }
+
+    eos_db_copy_((eos_u8_t *)eos.event[e_id].data.value + offset, memory, size);
+    tail->dirty |= eos_db_mask_(eos.object[e_id].size, offset, size);
+#if (EOS_USE_DB_PERSIST != 0)
+    if ((eos.object[e_id].attribute & EOS_DB_ATTRIBUTE_PERSISTENT) != 0)
+    {
+        eos_db_persist_mark_(eos.persist.save, e_id);
+    }
+#endif
+}
+
+static void eos_db_deadband_(const char *key, eos_u8_t type, eos_u32_t band)
+{
+    register eos_base_t level = eos_hw_interrupt_disable();
+
+    eos_u16_t e_id = eos_db_value_get_(key);
+    EOS_ASSERT_NAME((eos.object[e_id].attribute &
+                     EOS_DB_ATTRIBUTE_ON_CHANGE) != 0, key);
+    EOS_ASSERT_NAME((eos.object[e_id].size & 3) == 0, key);
+    eos_db_tail_t *tail = eos_db_tail_(e_id);
+    tail->band_type = type;
+    tail->band = band;
+
+    eos_hw_interrupt_enable(level);
+}
+
+/* The interrupt is only disabled for updating the counters, not for the
+   copying. */
+static void eos_db_value_write_(eos_u16_t e_id, const void *memory,
+                                eos_u32_t offset, eos_u32_t size)
+{
+    void *value = (eos_u8_t *)eos.event[e_id].data.value + offset;
+    eos_db_tail_t *seq = eos_db_tail_(e_id);
+
+    register eos_base_t level = eos_hw_interrupt_disable();
+    if (seq->nest == 0)
+    {
+        seq->seq ++;
+    }
+    seq->nest ++;
+    eos_u16_t claim = ++ seq->claim;
+    seq->dirty |= eos_db_mask_(eos.object[e_id].size, offset, size);
+#if (EOS_USE_DB_PERSIST != 0)
+    if ((eos.object[e_id].attribute & EOS_DB_ATTRIBUTE_PERSISTENT) != 0)
+    {
+        eos_db_persist_mark_(eos.persist.save, e_id);
+    }
+#endif
+    eos_hw_interrupt_enable(level);
+
+    while (1)
+    {
+        EOS_MEMORY_BARRIER();
+        eos_db_copy_(value, memory, size);
+        EOS_MEMORY_BARRIER();
+
+        level = eos_hw_interrupt_disable();
+        /* Another writer copied meanwhile, so the value may be mixed. */
+        if (seq->claim != claim)
+        {
+            claim = ++ seq->claim;
+            eos_hw_interrupt_enable(level);
+            continue;
+        }
+        seq->nest --;
+        if (seq->nest == 0)
+        {
+            seq->seq ++;
+        }
+        eos_hw_interrupt_enable(level);
+
+        break;
+    }
+}
+
+/* The reader never disables the interrupt. It copies again if the sequence is
+   changed. If one writer is copying, the reader task sleeps one tick to let
+   the writer finish, which it may have preempted. */
+static void eos_db_value_read_(eos_u16_t e_id, void *memory,
+                               eos_u32_t offset, eos_u32_t size)
+{
+    void *value = (eos_u8_t *)eos.event[e_id].data.value + offset;
+    eos_db_tail_t *seq = eos_db_tail_(e_id);
+
+    while (1)
+    {
+        eos_u32_t seq_begin = seq->seq;
+        if ((seq_begin & 1) != 0)
+        {
+            /* If this assert is trigged, read the value in one task. */
+            EOS_ASSERT(eos_interrupt_get_nest() == 0);
+            eos_task_delay(1);
+            continue;
+        }
+
+        EOS_MEMORY_BARRIER();
+        eos_db_copy_(memory, value, size);
+        EOS_MEMORY_BARRIER();
+
+        if (seq->seq == seq_begin)
+        {
+            break;
+        }
+    }
+}
+
+static inline bool eos_db_buffered_(eos_u16_t e_id)
+{
+    eos_u8_t temp8 = EOS_DB_ATTRIBUTE_VALUE | EOS_DB_ATTRIBUTE_BUFFERED;
+
+    return ((eos.object[e_id].attribute & temp8) == temp8);
+}
+
+static inline eos_db_version_t *eos_db_version_(eos_u16_t e_id)
+{
+    return (eos_db_version_t *)(eos_db_tail_(e_id) + 1);
+}
+
+static inline eos_u8_t *eos_db_version_data_(eos_u16_t e_id, eos_u32_t index)
+{
+    return ((eos_u8_t *)eos.event[e_id].data.value +
+            EOS_DB_TAIL_OFFSET(eos.object[e_id].size) * index);
+}
+
+static eos_u32_t eos_db_version_index_(eos_u16_t e_id, const void *data)
+{
+    const eos_u8_t *value = (const eos_u8_t *)eos.event[e_id].data.value;
+    eos_u32_t size_version = EOS_DB_TAIL_OFFSET(eos.object[e_id].size);
+    eos_u32_t offset = (eos_u32_t)((const eos_u8_t *)data - value);
+    /* If this assert is trigged, the data is not one version of the key. */
+    EOS_ASSERT((const eos_u8_t *)data >= value &&
+               (offset % size_version) == 0 &&
+               (offset / size_version) < EOS_DB_VERSIONS);
+
+    return (offset / size_version);
+}
+
+/* The acquiring and releasing are done with the interrupt disabled. */
+static eos_u32_t eos_db_version_acquire_(eos_u16_t e_id)
+{
+    eos_db_version_t *version = eos_db_version_(e_id);
+    eos_u32_t index = version->current;
+    /* If this assert is trigged, the version is never released. */
+    EOS_ASSERT(version->readers[index] != 0xFFFFU);
+    version->readers[index] ++;
+
+    return index;
+}
+
+static void eos_db_version_release_(eos_u16_t e_id, eos_u32_t index)
+{
+    eos_db_version_t *version = eos_db_version_(e_id);
+    /* If this assert is trigged, the version is released more than acquired. */
+    EOS_ASSERT(version->readers[index] != 0);
+    version->readers[index] --;
+}
+
+/* The writer waits while another writer holds its version, or every version
+   is current or read. It sleeps one tick every time, to let the readers it
+   may have preempted release. */
+static eos_u32_t eos_db_version_reserve_(eos_u16_t e_id)
+{
+    while (1)
+    {
+        register eos_base_t level = eos_hw_interrupt_disable();
+        eos_db_version_t *version = eos_db_version_(e_id);
+        if (version->reserved == EOS_DB_VERSIONS)
+        {
+            for (eos_u32_t i = 0; i < EOS_DB_VERSIONS; i ++)
+            {
+                if (i != version->current && version->readers[i] == 0)
+                {
+                    version->reserved = i;
+                    eos_hw_interrupt_enable(level);
+
+                    return i;
+                }
+            }
+        }
+        eos_hw_interrupt_enable(level);
+
+        /* If this assert is trigged, write the value in one task. */
+        EOS_ASSERT(eos_interrupt_get_nest() == 0);
+        eos_task_delay(1);
+    }
+}
+
+/* The readers acquiring later get the committed version at once. The version
+   committed with no region is neither dirty nor saved in the flash. */
+static void eos_db_version_commit_(eos_u16_t e_id,
+                                   eos_u32_t index, eos_u32_t mask)
+{
+    register eos_base_t level = eos_hw_interrupt_disable();
+
+    eos_db_version_t *version = eos_db_version_(e_id);
+    /* If this assert is trigged, the version is not the reserved one. */
+    EOS_ASSERT(version->reserved == index);
+    EOS_MEMORY_BARRIER();
+    version->current = index;
+    version->reserved = EOS_DB_VERSIONS;
+    eos_db_tail_(e_id)->dirty |= mask;
+#if (EOS_USE_DB_PERSIST != 0)
+    if (mask != 0 &&
+        (eos.object[e_id].attribute & EOS_DB_ATTRIBUTE_PERSISTENT) != 0)
+    {
+        eos_db_persist_mark_(eos.persist.save, e_id);
+    }
+#endif
+
+    eos_hw_interrupt_enable(level);
+}
+
+/* The bytes out of the range are copied from the current version, which is not
+   changed meanwhile, as the writers take turns. */
+static void eos_db_version_write_(eos_u16_t e_id, const void *memory,
+                                  eos_u32_t offset, eos_u32_t size)
+{
+    eos_u32_t size_value = eos.object[e_id].size;
+    eos_u32_t index = eos_db_version_reserve_(e_id);
+    eos_u8_t *data = eos_db_version_data_(e_id, index);
+    const eos_u8_t *current =
+        eos_db_version_data_(e_id, eos_db_version_(e_id)->current);
+
+    eos_db_copy_(data, current, offset);
+    eos_db_copy_(data + offset, memory, size);
+    eos_db_copy_(data + offset + size, current + offset + size,
+                 size_value - offset - size);
+
+    eos_db_version_commit_(e_id, index,
+                           eos_db_mask_(size_value, offset, size));
+}
+
+static void eos_db_version_read_(eos_u16_t e_id, void *memory,
+                                 eos_u32_t offset, eos_u32_t size)
+{
+    register eos_base_t level = eos_hw_interrupt_disable();
+    eos_u32_t index = eos_db_version_acquire_(e_id);
+    eos_hw_interrupt_enable(level);
+
+    eos_db_copy_(memory, eos_db_version_data_(e_id, index) + offset, size);
+
+    level = eos_hw_interrupt_disable();
+    eos_db_version_release_(e_id, index);
+    eos_hw_interrupt_enable(level);
+}
+
+eos_inline void eos_db_write_(eos_u8_t type,
+                                const char *key, eos_topic_t key_id,
+                                const void *memory, eos_u32_t size)
+{
+    /* The lock-free stream is written by its handle, without any lock. */
+    if (key_id < EOS_MAX_OBJECTS && type == EOS_EVENT_ATTRIBUTE_STREAM &&
+        (eos.object[key_id].attribute & EOS_DB_ATTRIBUTE_LOCK_FREE) != 0)
+    {
+        eos_stream_push(eos.event[key_id].data.stream, (void *)memory, size);
+        return;
+    }
+    /* The lock-free value is written by its handle, without any lock. */
+    if (key_id < EOS_MAX_OBJECTS && type == EOS_EVENT_ATTRIBUTE_VALUE &&
+        (eos.object[key_id].attribute & EOS_DB_ATTRIBUTE_LOCK_FREE) != 0)
+    {
+        eos_db_value_write_(key_id, memory, 0, eos.object[key_id].size);
+        return;
+    }
+
+    /* If in interrupt service function, disable the interrupt. */
+    register eos_base_t level = eos_hw_interrupt_disable();
+
+    /* Get event id according the topic. */
+    eos_u16_t e_id = key_id;
+    if (e_id == EOS_MAX_OBJECTS)
+    {
+        e_id = eos_hash_get_index(EosObj_Event, key);
+    }
+    EOS_ASSERT(e_id < EOS_MAX_OBJECTS);
+    EOS_ASSERT(eos.object[e_id].type == EosObj_Event);
+    eos_u8_t attribute = eos.object[e_id].attribute;
+    EOS_ASSERT((attribute & type) != 0);
+    eos_u32_t bits = (1 << eos_task_get_priority(eos_task_self()));
+
+    eos_u32_t size_remain;
+    /* Value type event key. */
+    if (type == EOS_EVENT_ATTRIBUTE_VALUE)
+    {
+        /* The lock-free value is copied after the key is found. */
+        if ((attribute & EOS_DB_ATTRIBUTE_LOCK_FREE) != 0)
+        {
+            eos_hw_interrupt_enable(level);
+            eos_db_value_write_(e_id, memory, 0, eos.object[e_id].size);
+            return;
+        }
+        /* The buffered value is copied into the spare version. */
+        if ((attribute & EOS_DB_ATTRIBUTE_BUFFERED) != 0)
+        {
+            eos_hw_interrupt_enable(level);
+            eos_db_version_write_(e_id, memory, 0, eos.object[e_id].size);
+            return;
+        }
+
+        /* Update the event's value. */
+        eos_db_value_update_(e_id, memory, 0, eos.object[e_id].size);
+    }
+    /* Stream type event key. */
+    else if (type == EOS_EVENT_ATTRIBUTE_STREAM)
+    {
+        /* Check if the remaining memory is enough or not. */
+        eos_stream_t *queue = eos.event[e_id].data.stream;
+        size_remain = eos_stream_empty_size(queue);
+        if (size_remain < size &&
+            (attribute & EOS_DB_ATTRIBUTE_OVERWRITE) != 0)
+        {
+            EOS_ASSERT(size <= queue->capacity);
+            eos_db_stream_overwrite_(e_id, size);
+            size_remain = size;
+        }
+        EOS_ASSERT(size_remain >= size ||
+                   (attribute & EOS_DB_ATTRIBUTE_LOCK_FREE) != 0);
+        /* Push all data to the queue, or drop it for the lock-free stream. */
+        eos_stream_push(queue, (void *)memory, size);
+        /* The broadcast stream keeps no data without any reader. */
+        if ((attribute & EOS_DB_ATTRIBUTE_BROADCAST) != 0 &&
+            owner_all_cleared(&eos.event[e_id].e_sub))
+        {
+            queue->tail = queue->head;
+        }
+        eos_db_stream_wake_(e_id);
+    }
+
+    eos_hw_interrupt_enable(level);
+}
+
+eos_inline eos_s32_t eos_db_read_(eos_u8_t type,
+                                    const char *key, eos_topic_t key_id,
+                                    const void *memory, eos_u32_t size)
+{
+    /* The lock-free stream is read by its handle, without any lock. */
+    if (key_id < EOS_MAX_OBJECTS && type == EOS_EVENT_ATTRIBUTE_STREAM &&
+        (eos.object[key_id].attribute & EOS_DB_ATTRIBUTE_LOCK_FREE) != 0)
+    {
+        return eos_stream_pull_pop(eos.event[key_id].data.stream,
+                                   (void *)memory, size);
+    }
+    /* The lock-free value is read by its handle, without any lock. */
+    if (key_id < EOS_MAX_OBJECTS && type == EOS_EVENT_ATTRIBUTE_VALUE &&
+        (eos.object[key_id].attribute & EOS_DB_ATTRIBUTE_LOCK_FREE) != 0)
+    {
+        eos_db_value_read_(key_id, (void *)memory,
+                           0, eos.object[key_id].size);
+        return size;
+    }
+
+    /* If in interrupt service function, disable the interrupt. */
+    register eos_base_t level = eos_hw_interrupt_disable();
+
+    /* Get event id according the topic. */
+    eos_u16_t e_id = key_id;
+    if (e_id == EOS_MAX_OBJECTS)
+    {
+        e_id = eos_hash_get_index(EosObj_Event, key);
+    }
+    EOS_ASSERT(e_id < EOS_MAX_OBJECTS);
+    EOS_ASSERT(eos.object[e_id].type == EosObj_Event);
+    eos_u8_t attribute = eos.object[e_id].attribute;
+    EOS_ASSERT((attribute & type) != 0);
+    eos_u32_t bits = (1 << eos_task_get_priority(eos_task_self()));
+
+    /* Value type. */
+    eos_s32_t ret_size = 0;
+    if (type == EOS_EVENT_ATTRIBUTE_VALUE)
+    {
+        /* The lock-free value is copied after the key is found. */
+        if ((attribute & EOS_DB_ATTRIBUTE_LOCK_FREE) != 0)
+        {
+            eos_hw_interrupt_enable(level);
+            eos_db_value_read_(e_id, (void *)memory, 0, eos.object[e_id].size);
+            return size;
+        }
+        if ((attribute & EOS_DB_ATTRIBUTE_BUFFERED) != 0)
+        {
+            eos_hw_interrupt_enable(level);
+            eos_db_version_read_(e_id, (void *)memory,
+                                 0, eos.object[e_id].size);
+            return size;
+        }
+
+        /* Update the event's value. */
+        eos_db_copy_((void *)memory, eos.event[e_id].data.value,
+                     eos.object[e_id].size);
+
+        ret_size = size;
+    }
+    /* Stream type. */
+    else if (type == EOS_EVENT_ATTRIBUTE_STREAM)
+    {
+        /* Check if the remaining memory is enough or not. */
+        eos_stream_t *queue = eos.event[e_id].data.stream;
+        if ((attribute & EOS_DB_ATTRIBUTE_BROADCAST) == 0)
+        {
+            ret_size = eos_stream_pull_pop(queue, (void *)memory, size);
+        }
+        /* Every reader of the broadcast stream has its own cursor. */
+        else
+        {
+            volatile eos_u32_t *cursor = eos_db_stream_cursor_(e_id);
+            eos_u32_t size_stream = stream_used(queue, queue->head, *cursor);
+            size = (size_stream < size) ? size_stream : size;
+            stream_copy_out(queue, *cursor, (void *)memory, size);
+            *cursor = stream_forward(queue, *cursor, size);
+            eos_db_stream_tail_update_(e_id);
+            ret_size = size;
+        }
+        eos_db_stream_wake_(e_id);
+    }
+
+    eos_hw_interrupt_enable(level);
+
+    return ret_size;
+}
+
+/* private sm function ------------------------------------------------------ */
+#if (EOS_USE_SM_MODE != 0)
+eos_ret_t eos_tran(eos_sm_t *const me, eos_state_handler state)
+{
+    me->state = state;
+
+    return EOS_Ret_Tran;
+}
+
+eos_ret_t eos_super(eos_sm_t *const me, eos_state_handler state)
+{
+    me->state = state;
+
+    return EOS_Ret_Super;
+}
+
+eos_ret_t eos_state_top(eos_sm_t *const me, eos_event_t const * const e)
+{
+    (void)me;
+    (void)e;
+
+    return EOS_Ret_Null;
+}
+#endif
+
+#if (EOS_USE_SM_MODE != 0)
+static void eos_sm_dispath(eos_sm_t *const me, eos_event_t const * const e)
+{
+#if (EOS_USE_HSM_MODE != 0)
+    eos_state_handler path[EOS_MAX_HSM_NEST_DEPTH];
+#endif
+    eos_ret_t r;
+
+    EOS_ASSERT(e != (eos_event_t *)0);
+
+#if (EOS_USE_HSM_MODE == 0)
+    eos_state_handler s = me->state;
+    eos_state_handler t;
+    
+    r = s(me, e);
+    if (r == EOS_Ret_Tran)
+    {
+        t = me->state;
+        r = s(me, &eos_event_table[Event_Exit]);
+        EOS_ASSERT(r == EOS_Ret_Handled || r == EOS_Ret_Super);
+        r = t(me, &eos_event_table[Event_Enter]);
+        EOS_ASSERT(r == EOS_Ret_Handled || r == EOS_Ret_Super);
+        me->state = t;
+    }
+    else
+    {
+        me->state = s;
+    }
+#else
+    eos_state_handler t = me->state;
+    eos_state_handler s;
+
+    do {
+        s = me->state;
+        r = (*s)(me, e);
+    } while (r == EOS_Ret_Super);
+
+    if (r != EOS_Ret_Tran)
+    {
+        me->state = t;
+        return;
+    }
+
+    path[0] = me->state;
+    path[1] = t;
+    path[2] = s;
+
+    /* exit current state to transition source s... */
+    while (t != s)
+    {
+        /* exit handled? */
+        if (HSM_TRIG_(t, Event_Exit) == EOS_Ret_Handled)
+        {
+            (void)HSM_TRIG_(t, Event_Null); /* find superstate of t */
+        }
+        t = me->state; /* stateTgt_ holds the superstate */
+    }
+
+    eos_s32_t ip = eos_sm_tran(me, path); /* take the HSM transition */
+
+    /* retrace the entry path in reverse (desired) order... */
+    for (; ip >= 0; --ip)
+    {
+        HSM_TRIG_(path[ip], Event_Enter); /* enter path[ip] */
+    }
+    t = path[0];    /* stick the target into register */
+    me->state = t; /* update the next state */
+
+    while (HSM_TRIG_(t, Event_Init) == EOS_Ret_Tran)
+    {
+        ip = 0;
+        path[0] = me->state;
+        (void)HSM_TRIG_(me->state, Event_Null);
+        while (me->state != t)
+        {
+            ip++;
+            path[ip] = me->state;
+            (void)HSM_TRIG_(me->state, Event_Null);
+        }
+        me->state = path[0];
+
+        EOS_ASSERT(ip < EOS_MAX_HSM_NEST_DEPTH);
+
+        /* retrace the entry path in reverse (correct) order... */
+        do {
+            HSM_TRIG_(path[ip --], Event_Enter);
+        } while (ip >= 0);
+
+        t = path[0];
+    }
+
+    me->state = t;
+#endif
+}
+
+#if (EOS_USE_HSM_MODE != 0)
+static eos_s32_t eos_sm_tran(eos_sm_t *const me,
+                           eos_state_handler path[EOS_MAX_HSM_NEST_DEPTH])
+{
+    /* transition entry path index */
+    eos_s32_t ip = -1;
+    eos_s32_t iq; /* helper transition entry path index */
+    eos_state_handler t = path[0];
+    eos_state_handler s = path[2];
+    eos_ret_t r;
+
+    /* (a) 跳转到自身 s == t */
+    if (s == t)
+    {
+        HSM_TRIG_(s, Event_Exit);  /* exit the source */
+        return 0; /* cause entering the target */
+    }
+
+    (void)HSM_TRIG_(t, Event_Null); /* superstate of target */
+    t = me->state;
+
+    /* (b) check source == target->super */
+    if (s == t)
+        return 0; /* cause entering the target */
+
+    (void)HSM_TRIG_(s, Event_Null); /* superstate of src */
+
+    /* (c) check source->super == target->super */
+    if (me->state == t)
+    {
+        HSM_TRIG_(s, Event_Exit);  /* exit the source */
+        return 0; /* cause entering the target */
+    }
+
+    /* (d) check source->super == target */
+    if (me->state == path[0])
+    {
+        HSM_TRIG_(s, Event_Exit); /* exit the source */
+        return -1;
+    }
+
+    /* (e) check rest of source == target->super->super.. */
+    /* and store the entry path along the way */
+
+    /* indicate that the LCA was not found */
+    iq = 0;
+
+    /* enter target and its superstate */
+    ip = 1;
+    path[1] = t; /* save the superstate of target */
+    t = me->state; /* save source->super */
+
+    /* find target->super->super */
+    r = HSM_TRIG_(path[1], Event_Null);
+    while (r == EOS_Ret_Super)
+    {
+       ++ ip;
+        path[ip] = me->state; /* store the entry path */
+        if (me->state == s)
+        { /* is it the source? */
+            /* indicate that the LCA was found */
+            iq = 1;
+
+            /* entry path must not overflow */
+            EOS_ASSERT(ip < EOS_MAX_HSM_NEST_DEPTH);
+            --ip;  /* do not enter the source */
+            r = EOS_Ret_Handled; /* terminate the loop */
+        }
+        /* it is not the source, keep going up */
+        else
+            r = HSM_TRIG_(me->state, Event_Null);
+    }
+
+    /* LCA found yet? */
+    if (iq == 0)
+    {
+        /* entry path must not overflow */
+        EOS_ASSERT(ip < EOS_MAX_HSM_NEST_DEPTH);
+
+        HSM_TRIG_(s, Event_Exit); /* exit the source */
+
+        /* (f) check the rest of source->super */
+        /*                  == target->super->super... */
+        iq = ip;
+        r = EOS_Ret_Null; /* indicate LCA NOT found */
+        do {
+            /* is this the LCA? */
+            if (t == path[iq])
+            {
+                r = EOS_Ret_Handled; /* indicate LCA found */
+                /* do not enter LCA */
+                ip = iq - 1;
+                /* cause termination of the loop */
+                iq = -1;
+            }
+            else
+                -- iq; /* try lower superstate of target */
+        } while (iq >= 0);
+
+        /* LCA not found yet? */
+        if (r != EOS_Ret_Handled)
+        {
+            /* (g) check each source->super->... */
+            /* for each target->super... */
+            r = EOS_Ret_Null; /* keep looping */
+            do {
+                /* exit t unhandled? */
+                if (HSM_TRIG_(t, Event_Exit) == EOS_Ret_Handled)
+                {
+                    (void)HSM_TRIG_(t, Event_Null);
+                }
+                t = me->state; /*  set to super of t */
+                iq = ip;
+                do {
+                    /* is this LCA? */
+                    if (t == path[iq])
+                    {
+                        /* do not enter LCA */
+                        ip = iq - 1;
+                        /* break out of inner loop */
+                        iq = -1;
+                        r = EOS_Ret_Handled; /* break outer loop */
+                    }
+                    else
+                        --iq;
+                } while (iq >= 0);
+            } while (r != EOS_Ret_Handled);
+        }
+    }
+
+    return ip;
+}
+#endif
+#endif
+
+/* private heap function ---------------------------------------------------- */
+#if (EOS_USE_HEAP_TLSF != 0)
+/*
+ * The TLSF (two-level segregated fit) heap. The free blocks are put into the
+ * lists sorted by the size class. The first level is the power of 2, and the
+ * second level divides it linearly. Both malloc and free are in constant time.
+ */
+void eos_heap_init(eos_heap_t *const me, void *data, eos_u32_t size)
+{
+    EOS_ASSERT(data != EOS_NULL);
+
+    eos_u32_t mod = ((eos_u32_t)data % EOS_HEAP_ALIGN);
+    if (mod != 0)
+    {
+        data = (void *)((eos_u8_t *)data + EOS_HEAP_ALIGN - mod);
+        size = size - (EOS_HEAP_ALIGN - mod);
+    }
+    size &= ~(EOS_HEAP_ALIGN - 1);
+
+    /* One block head is used by the sentinel block at the end. */
+    EOS_ASSERT(size >= (2 * EOS_HEAP_BLOCK_HEAD + EOS_HEAP_BLOCK_MIN));
+    size -= (2 * EOS_HEAP_BLOCK_HEAD);
+    /* If this assert is trigged, enlarge EOS_HEAP_FL_COUNT. */
+    EOS_ASSERT(size < EOS_HEAP_SIZE_LIMIT);
+
+    me->data = data;
+    me->size = size;
+    me->error_id = 0;
+    me->size_used = 0;
+    me->size_used_max = 0;
+    me->fl_bitmap = 0;
+    for (eos_u32_t i = 0; i < EOS_HEAP_FL_COUNT; i++)
+    {
+        me->sl_bitmap[i] = 0;
+        for (eos_u32_t j = 0; j < EOS_HEAP_SL_COUNT; j++)
+        {
+            me->blocks[i][j] = EOS_NULL;
+        }
+    }
+
+    /* The 1st free block, and the used sentinel block with zero size. */
+    eos_heap_block_t *block = (eos_heap_block_t *)me->data;
+    block->prev_phys = EOS_NULL;
+    block->size = size | 1;
+    eos_heap_block_t *sentinel = heap_block_next(block);
+    sentinel->prev_phys = block;
+    sentinel->size = 0;
+
+    heap_block_insert(me, block);
+}
+
+void * eos_heap_malloc(eos_heap_t *const me, eos_u32_t size)
+{
+    eos_u32_t fl, sl;
+
+    if (size == 0)
+    {
+        me->error_id = 1;
+        return EOS_NULL;
+    }
+
+    size = (size + EOS_HEAP_ALIGN - 1) & ~(EOS_HEAP_ALIGN - 1);
+    if (size < EOS_HEAP_BLOCK_MIN)
+    {
+        size = EOS_HEAP_BLOCK_MIN;
+    }
+    if (size > me->size)
+    {
+        me->error_id = 2;
+        return EOS_NULL;
+    }
+
+    /* Round up to the next size class, so any block in it is big enough. */
+    eos_u32_t size_search = size;
+    if (size_search >= EOS_HEAP_SMALL)
+    {
+        size_search += (1U << (heap_fls(size_search) - EOS_HEAP_SL_LOG2)) - 1;
+    }
+    heap_mapping(size_search, &fl, &sl);
+
+    /* Find the first non-empty list in the size classes. */
+    eos_u32_t sl_map = 0;
+    if (fl < EOS_HEAP_FL_COUNT)
+    {
+        sl_map = me->sl_bitmap[fl] & (~0U << sl);
+    }
+    if (sl_map == 0)
+    {
+        eos_u32_t fl_map = (fl + 1 < EOS_HEAP_FL_COUNT) ?
+                            (me->fl_bitmap & (~0U << (fl + 1))) : 0;
+        if (fl_map == 0)
+        {
+            me->error_id = 2;
+            return EOS_NULL;
+        }
+        fl = __eos_ffs((int)fl_map) - 1;
+        sl_map = me->sl_bitmap[fl];
+    }
+    sl = __eos_ffs((int)sl_map) - 1;
+
+    eos_heap_block_t *block = me->blocks[fl][sl];
+    heap_block_remove(me, block);
+
+    /* Divide the block into two blocks, if the rest is big enough. */
+    eos_u32_t size_block = heap_block_size(block);
+    if (size_block >= (size + EOS_HEAP_BLOCK_HEAD + EOS_HEAP_BLOCK_MIN))
+    {
+        eos_heap_block_t *rest =
+            (eos_heap_block_t *)((eos_u8_t *)block + EOS_HEAP_BLOCK_HEAD + size);
+        rest->prev_phys = block;
+        rest->size = (size_block - size - EOS_HEAP_BLOCK_HEAD) | 1;
+        heap_block_next(rest)->prev_phys = rest;
+        heap_block_insert(me, rest);
+        size_block = size;
+    }
+    block->size = size_block;
+
+    me->size_used += size_block;
+    if (me->size_used > me->size_used_max)
+    {
+        me->size_used_max = me->size_used;
+    }
+    me->error_id = 0;
+
+    return (void *)((eos_u8_t *)block + EOS_HEAP_BLOCK_HEAD);
+}
+
+void eos_heap_free(eos_heap_t *const me, void * data)
+{
+    eos_heap_block_t *block =
+        (eos_heap_block_t *)((eos_u8_t *)data - EOS_HEAP_BLOCK_HEAD);
+
+    /* The block is already free. */
+    if ((block->size & 1) != 0)
+    {
+        me->error_id = 4;
+        return;
+    }
+
+    me->size_used -= block->size;
+    block->size |= 1;
+
+    /* Check the block can be combined with the front one. */
+    eos_heap_block_t *prev = block->prev_phys;
+    if (prev != EOS_NULL && (prev->size & 1) != 0)
+    {
+        heap_block_remove(me, prev);
+        prev->size += (EOS_HEAP_BLOCK_HEAD + heap_block_size(block));
+        block = prev;
+        heap_block_next(block)->prev_phys = block;
+    }
+
+    /* Check the block can be combined with the later one. */
+    eos_heap_block_t *next = heap_block_next(block);
+    if ((next->size & 1) != 0)
+    {
+        heap_block_remove(me, next);
+        block->size += (EOS_HEAP_BLOCK_HEAD + heap_block_size(next));
+        heap_block_next(block)->prev_phys = block;
+    }
+
+    heap_block_insert(me, block);
+    me->error_id = 0;
+}
+
+void eos_heap_stats(eos_heap_t *const me, eos_heap_stats_t * const stats)
+{
+    stats->size = me->size;
+    stats->size_free = 0;
+    stats->size_free_max = 0;
+    stats->size_used_max = me->size_used_max;
+
+    /* Walk through all the blocks until the sentinel block. */
+    eos_heap_block_t *block = (eos_heap_block_t *)me->data;
+    while (heap_block_size(block) != 0)
+    {
+        if ((block->size & 1) != 0)
+        {
+            stats->size_free += heap_block_size(block);
+            if (heap_block_size(block) > stats->size_free_max)
+            {
+                stats->size_free_max = heap_block_size(block);
+            }
+        }
+        block = heap_block_next(block);
+    }
+
+    stats->fragment = (stats->size_free == 0) ? 0 :
+        (eos_u8_t)(100 - (stats->size_free_max * 100 / stats->size_free));
+}
+
+static inline eos_u32_t heap_fls(eos_u32_t value)
+{
+    eos_u32_t bit = 0;
+
+    if (value & 0xffff0000U)
+    {
+        bit += 16;
+        value >>= 16;
+    }
+    if (value & 0xff00U)
+    {
+        bit += 8;
+        value >>= 8;
+    }
+    if (value & 0xf0U)
+    {
+        bit += 4;
+        value >>= 4;
+    }
+    if (value & 0xcU)
+    {
+        bit += 2;
+        value >>= 2;
+    }
+    if (value & 0x2U)
+    {
+        bit += 1;
+    }
+
+    return bit;
+}
+
+static inline eos_u32_t heap_block_size(eos_heap_block_t *block)
+{
+    return (block->size & ~1U);
+}
+
+static inline eos_heap_block_t *heap_block_next(eos_heap_block_t *block)
+{
+    return (eos_heap_block_t *)((eos_u8_t *)block +
+                                EOS_HEAP_BLOCK_HEAD + heap_block_size(block));
+}
+
+static inline void heap_mapping(eos_u32_t size, eos_u32_t *fl, eos_u32_t *sl)
+{
+    if (size < EOS_HEAP_SMALL)
+    {
+        *fl = 0;
+        *sl = size / (EOS_HEAP_SMALL / EOS_HEAP_SL_COUNT);
+    }
+    else
+    {
+        eos_u32_t bit = heap_fls(size);
+        *sl = (size >> (bit - EOS_HEAP_SL_LOG2)) ^ EOS_HEAP_SL_COUNT;
+        *fl = bit - (EOS_HEAP_FL_SHIFT - 1);
+    }
+}
+
+static void heap_block_insert(eos_heap_t *const me, eos_heap_block_t *block)
+{
+    eos_u32_t fl, sl;
+    heap_mapping(heap_block_size(block), &fl, &sl);
+
+    block->prev_free = EOS_NULL;
+    block->next_free = me->blocks[fl][sl];
+    if (block->next_free != EOS_NULL)
+    {
+        block->next_free->prev_free = block;
+    }
+    me->blocks[fl][sl] = block;
+
+    me->fl_bitmap |= (1U << fl);
+    me->sl_bitmap[fl] |= (1U << sl);
+}
+
+static void heap_block_remove(eos_heap_t *const me, eos_heap_block_t *block)
+{
+    eos_u32_t fl, sl;
+    heap_mapping(heap_block_size(block), &fl, &sl);
+
+    if (block->next_free != EOS_NULL)
+    {
+        block->next_free->prev_free = block->prev_free;
+    }
+    if (block->prev_free != EOS_NULL)
+    {
+        block->prev_free->next_free = block->next_free;
+    }
+    else
+    {
+        me->blocks[fl][sl] = block->next_free;
+        if (me->blocks[fl][sl] == EOS_NULL)
+        {
+            me->sl_bitmap[fl] &= ~(1U << sl);
+            if (me->sl_bitmap[fl] == 0)
+            {
+                me->fl_bitmap &= ~(1U << fl);
+            }
+        }
+    }
+}
+
+#else
+void eos_heap_init(eos_heap_t *const me, void *data, eos_u32_t size)
+{
+    EOS_ASSERT(data != EOS_NULL);
+    EOS_ASSERT(size > sizeof(eos_heap_block_t));
+
+    eos_u32_t mod = ((eos_u32_t)data % 4);
+    if (mod != 0)
+    {
+        data = (void *)((eos_u32_t)data + 4 - mod);
+        size = size - 4;
+    }
+    
+    /* block start */
+    me->data = data;
+    me->list = (eos_heap_block_t *)me->data;
+    me->size = size;
+    me->error_id = 0;
+    me->size_used = 0;
+    me->size_used_max = 0;
+
+    /* the 1st free block */
+    eos_heap_block_t *block_1st;
+    block_1st = (eos_heap_block_t *)me->data;
+    block_1st->next = EOS_NULL;
+    block_1st->size = size - (eos_u32_t)sizeof(eos_heap_block_t);
+    block_1st->is_free = 1;
+}
+
+void * eos_heap_malloc(eos_heap_t *const me, eos_u32_t size)
+{
+    eos_heap_block_t *block;
+    
+    if (size == 0)
+    {
+        me->error_id = 1;
+        return EOS_NULL;
+    }
+
+    eos_u32_t mod = (size % 4);
+    if (mod != 0)
+    {
+        size = size + 4 - mod;
+    }
+
+    /* Find the first free block in the block-list. */
+    block = (eos_heap_block_t *)me->list;
+    do
+    {
+        if (block->is_free == 1 &&
+            block->size > (size + sizeof(eos_heap_block_t)))
+        {
+            break;
+        }
+        else
+        {
+            block = block->next;
+        }
+    } while (block != EOS_NULL);
+
+    if (block == EOS_NULL)
+    {
+        me->error_id = 2;
+        return EOS_NULL;
+    }
+
+    /* If the block's byte number is NOT enough to create a new block. */
+    if (block->size <= (eos_u32_t)((eos_u32_t)size + sizeof(eos_heap_block_t)))
+    {
+        block->is_free = 0;
+    }
+    /* Divide the block into two blocks. */
+    else
+    {
+        eos_heap_block_t *new_block
+            = (eos_heap_block_t *)((eos_u32_t)block + size + sizeof(eos_heap_block_t));
+        new_block->size = block->size - size - sizeof(eos_heap_block_t);
+        new_block->is_free = 1;
+        new_block->next = EOS_NULL;
+
+        /* Update the list. */
+        new_block->next = block->next;
+        block->next = new_block;
+        block->size = size;
+        block->is_free = 0;
+    }
+
+    me->size_used += block->size;
+    if (me->size_used > me->size_used_max)
+    {
+        me->size_used_max = me->size_used;
+    }
+    me->error_id = 0;
+
+    return (void *)((eos_u32_t)block + (eos_u32_t)sizeof(eos_heap_block_t));
+}
+
+void eos_heap_free(eos_heap_t *const me, void * data)
+{
+    eos_heap_block_t *block_crt =
+        (eos_heap_block_t *)((eos_u32_t)data - sizeof(eos_heap_block_t));
+
+    /* Search for this block in the block-list. */
+    eos_heap_block_t *block = me->list;
+    eos_heap_block_t *block_last = EOS_NULL;
+    do
+    {
+        if (block->is_free == 0 && block == block_crt)
+        {
+            break;
+        }
+        else
+        {
+            block_last = block;
+            block = block->next;
+        }
+    } while (block != EOS_NULL);
+
+    /* Not found. */
+    if (block == EOS_NULL)
+    {
+        me->error_id = 4;
+        return;
+    }
+
+    me->size_used -= block->size;
+    block->is_free = 1;
+    /* Check the block can be combined with the front one. */
+    if (block_last != (eos_heap_block_t *)NULL && block_last->is_free == 1)
+    {
+        block_last->size += (block->size + sizeof(eos_heap_block_t));
+        block_last->next = block->next;
+        block = block_last;
+    }
+
+    /* Check the block can be combined with the later one. */
+    if (block->next != (eos_heap_block_t *)EOS_NULL && block->next->is_free == 1)
+    {
+        block->size += (block->next->size + (eos_u32_t)sizeof(eos_heap_block_t));
+        block->next = block->next->next;
+        block->is_free = 1;
+    }
+
+    me->error_id = 0;
+}
+
+void eos_heap_stats(eos_heap_t *const me, eos_heap_stats_t * const stats)
+{
+    stats->size = me->size;
+    stats->size_free = 0;
+    stats->size_free_max = 0;
+    stats->size_used_max = me->size_used_max;
+
+    for (eos_heap_block_t *block = me->list;
+         block != EOS_NULL; block = block->next)
+    {
+        if (block->is_free == 1)
+        {
+            stats->size_free += block->size;
+            if (block->size > stats->size_free_max)
+            {
+                stats->size_free_max = block->size;
+            }
+        }
+    }
+
+    stats->fragment = (stats->size_free == 0) ? 0 :
+        (eos_u8_t)(100 - (stats->size_free_max * 100 / stats->size_free));
+}
+#endif
+
+/* private hash function ---------------------------------------------------- */
+
+static eos_u32_t eos_hash_time33(char ch_type, const char *string)
+{
+    eos_u16_t length;
+
+    return eos_hash_time33_len(ch_type, string, &length);
+}
+
+/* The length of the key is got in the same pass as the hash value, so the key
+   strings are only compared when both the hash and the length are equal. */
+static eos_u32_t eos_hash_time33_len(char ch_type, const char *string,
+                                        eos_u16_t *length)
+{
+    const char *start = string;
+    eos_u32_t hash = 5381;
+    hash += (hash << 5) + ch_type;
+    while (*string)
+    {
+        hash += (hash << 5) + (*string++);
+    }
+    *length = (eos_u16_t)(string - start);
+
+    return (eos_u32_t)(hash & (0x7fffffff));
+}
+
+/* The distance of the object in the slot to its initial slot. */
+static inline eos_u16_t eos_hash_distance_(eos_u16_t slot, eos_u16_t id)
+{
+    eos_u16_t index_init = eos.object[id].hash % eos.prime_max;
+
+    return (eos_u16_t)((slot + EOS_MAX_OBJECTS - index_init) % EOS_MAX_OBJECTS);
+}
+
+/* The hash index is seeked forward from the initial slot in the Robin Hood
+   way, so the seeking is stopped at an empty slot, or at an object nearer to
+   its initial slot than the seeking distance. Only the index of the object
+   type is seeked, and the objects of other types are never touched. The hash
+   value and the length are compared before the string, so the keys with the
+   same hash value are different objects. */
+static eos_u16_t eos_hash_find_(eos_u8_t obj_type, eos_u32_t hash,
+                                const char *string, eos_u16_t length)
+{
+    eos_u16_t *index = eos.index[obj_type];
+    eos_u16_t slot;
+
+#if (EOS_USE_TOPIC_TABLE != 0)
+    /* The known key is found in one probe of the perfect hash table. */
+    slot = eos_topic_table_slot_(hash);
+    if (eos_topic_table[slot].hash == hash &&
+        eos_topic_table[slot].type == obj_type &&
+        eos_topic_table[slot].key_len == length &&
+        memcmp(eos_topic_table[slot].key, string, length) == 0)
+    {
+        return slot;
+    }
+#endif
+
+    slot = hash % eos.prime_max;
+    for (eos_u16_t i = 0; i <= EOS_MAX_HASH_SEEK_TIMES; i++)
+    {
+        eos_u16_t id = index[slot];
+        if (id == EOS_MAX_OBJECTS || eos_hash_distance_(slot, id) < i)
+        {
+            break;
+        }
+        if (eos.object[id].hash == hash &&
+            eos.object[id].key_len == length &&
+            memcmp(eos.object[id].key, string, length) == 0)
+        {
+            return id;
+        }
+
+        slot = (slot + 1) % EOS_MAX_OBJECTS;
+    }
+
+    return EOS_MAX_OBJECTS;
+}
+
+static eos_u16_t eos_hash_insert(eos_u8_t obj_type, const char *string)
+{
+    eos_u16_t *index = eos.index[obj_type];
+    eos_u16_t length;
+
+    /* Calculate the hash value and the length of the string. */
+    eos_u32_t hash = eos_hash_time33_len(ch_type[obj_type], string, &length);
+
+    /* The key with the same hash value as another one is inserted as well,
+       and found by its string. */
+    eos_u16_t id = eos_hash_find_(obj_type, hash, string, length);
+    if (id != EOS_MAX_OBJECTS)
+    {
+        return id;
+    }
+
+    /* Find one free object in the object table. */
+    id = 0;
+    while (id < EOS_MAX_OBJECTS && eos.object[id].key != (const char *)0)
+    {
+        id ++;
+    }
+    EOS_ASSERT_NAME(id != EOS_MAX_OBJECTS, string);
+
+    /* The object may be used before, so all of it is cleared. */
+    memset(&eos.object[id], 0, sizeof(eos_object_t));
+    memset(&eos.event[id], 0, sizeof(eos_obj_event_t));
+    eos.object[id].block = EOS_MAX_OBJECTS;
+    eos.object[id].key = string;
+    eos.object[id].hash = hash;
+    eos.object[id].key_len = length;
+    eos.object[id].type = obj_type;
+
+    /* The object takes the slot of the one nearer to its initial slot, and the
+       displaced one goes on seeking, so the seeking distances are even. */
+    eos_u16_t slot = hash % eos.prime_max;
+    eos_u16_t distance = 0;
+    eos_u16_t id_insert = id;
+    while (index[slot] != EOS_MAX_OBJECTS)
+    {
+        eos_u16_t distance_slot = eos_hash_distance_(slot, index[slot]);
+        if (distance_slot < distance)
+        {
+            eos_u16_t id_temp = index[slot];
+            index[slot] = id_insert;
+            id_insert = id_temp;
+            distance = distance_slot;
+        }
+
+        slot = (slot + 1) % EOS_MAX_OBJECTS;
+        distance ++;
+
+        /* If this assert is trigged, you need to enlarge the hash table size.
+           The seeking distances are got by eos_hash_info(). */
+        EOS_ASSERT_NAME(distance <= EOS_MAX_HASH_SEEK_TIMES, string);
+    }
+    index[slot] = id_insert;
+
+    return id;
+}
+
+/* The object is removed by shifting the following ones backward, so no
+   tombstone is left, and the seeking is never longer after removing. */
+static void eos_hash_remove(eos_u8_t obj_type, eos_u16_t id)
+{
+    eos_u16_t *index = eos.index[obj_type];
+    eos_u16_t slot = eos.object[id].hash % eos.prime_max;
+
+#if (EOS_USE_TOPIC_TABLE != 0)
+    /* The known keys are never removed. */
+    EOS_ASSERT(id >= EOS_TOPIC_TABLE_SIZE);
+#endif
+
+    for (eos_u16_t i = 0; index[slot] != id; i++)
+    {
+        /* If this assert is trigged, the object is not in the index. */
+        EOS_ASSERT(i < EOS_MAX_HASH_SEEK_TIMES);
+        slot = (slot + 1) % EOS_MAX_OBJECTS;
+    }
+
+    while (1)
+    {
+        eos_u16_t slot_next = (slot + 1) % EOS_MAX_OBJECTS;
+        eos_u16_t id_next = index[slot_next];
+        if (id_next == EOS_MAX_OBJECTS ||
+            eos_hash_distance_(slot_next, id_next) == 0)
+        {
+            break;
+        }
+        index[slot] = id_next;
+        slot = slot_next;
+    }
+    index[slot] = EOS_MAX_OBJECTS;
+    eos.object[id].key = (const char *)0;
+}
+
+static eos_u16_t eos_hash_get_index(eos_u8_t obj_type, const char *string)
+{
+    eos_u16_t length;
+    eos_u32_t hash = eos_hash_time33_len(ch_type[obj_type], string, &length);
+
+    return eos_hash_find_(obj_type, hash, string, length);
+}
+
+/* The hash value is given, and the string is only measured for comparing. */
+static eos_u16_t eos_hash_get_index_hashed(eos_u8_t obj_type, eos_u32_t hash,
+                                           const char *string)
+{
+    return eos_hash_find_(obj_type, hash, string, (eos_u16_t)strlen(string));
+}
+
+/* private stream function -------------------------------------------------- */
+static eos_s32_t eos_stream_init(eos_stream_t *const me, void *memory, eos_u32_t capacity)
+{
+    me->data = memory;
+    me->capacity = capacity;
+    me->head = 0;
+    me->tail = 0;
+    me->dropped = 0;
+    me->level_high = 1;
+    me->level_low = capacity;
+    memset(&me->t_read, 0, sizeof(eos_owner_t));
+    memset(&me->t_write, 0, sizeof(eos_owner_t));
+
+    return Stream_OK;
+}
+
+/* The offset in the memory of one index. */
+static inline eos_u32_t stream_offset(eos_stream_t *const me, eos_u32_t index)
+{
+    return (index < me->capacity) ? index : (index - me->capacity);
+}
+
+static inline eos_u32_t stream_forward(eos_stream_t *const me,
+                                       eos_u32_t index, eos_u32_t size)
+{
+    index += size;
+    if (index >= (me->capacity << 1))
+    {
+        index -= (me->capacity << 1);
+    }
+
+    return index;
+}
+
+static inline eos_u32_t stream_used(eos_stream_t *const me,
+                                    eos_u32_t head, eos_u32_t tail)
+{
+    return (head >= tail) ? (head - tail) : ((me->capacity << 1) - tail + head);
+}
+
+/* Only the producer calls it. The data is written before the head is moved,
+   and the barriers keep this order for the consumer. */
+static eos_s32_t eos_stream_push(eos_stream_t *const me, void * data, eos_u32_t size)
+{
+    eos_u32_t head = me->head;
+    eos_u32_t tail = me->tail;
+    EOS_MEMORY_BARRIER();
+
+    eos_u32_t size_free = me->capacity - stream_used(me, head, tail);
+    if (size_free < size)
+    {
+        me->dropped ++;
+        return (size_free == 0) ? Stream_Full : Stream_NotEnough;
+    }
+
+    /* The data is copied to the end of the memory, and then the rest to the
+       beginning. */
+    eos_u8_t *stream = (eos_u8_t *)me->data;
+    eos_u32_t offset = stream_offset(me, head);
+    eos_u32_t size_first = me->capacity - offset;
+    size_first = (size < size_first) ? size : size_first;
+    memcpy(&stream[offset], data, size_first);
+    memcpy(stream, (eos_u8_t *)data + size_first, size - size_first);
+
+    EOS_MEMORY_BARRIER();
+    me->head = stream_forward(me, head, size);
+
+    return Stream_OK;
+}
+
+/* Only the consumer calls it. The data is read before the tail is moved. */
+static eos_s32_t eos_stream_pull_pop(eos_stream_t *const me, void * data, eos_u32_t size)
+{
+    eos_u32_t head = me->head;
+    eos_u32_t tail = me->tail;
+    EOS_MEMORY_BARRIER();
+
+    eos_u32_t size_stream = stream_used(me, head, tail);
+    size = (size_stream < size) ? size_stream : size;
+    if (size == 0)
+    {
+        return 0;
+    }
+
+    stream_copy_out(me, tail, data, size);
+
+    EOS_MEMORY_BARRIER();
+    me->tail = stream_forward(me, tail, size);
+
+    return size;
+}
+
+/* Copy size bytes from the index out, in two segments at most. */
+static eos_u32_t stream_copy_out(eos_stream_t *const me, eos_u32_t index,
+                                 void *data, eos_u32_t size)
+{
+    eos_u8_t *stream = (eos_u8_t *)me->data;
+    eos_u32_t offset = stream_offset(me, index);
+    eos_u32_t size_first = me->capacity - offset;
+    size_first = (size < size_first) ? size : size_first;
+    memcpy(data, &stream[offset], size_first);
+    memcpy((eos_u8_t *)data + size_first, stream, size - size_first);
+
+    return size;
+}
+
+static eos_s32_t eos_stream_size(eos_stream_t *const me)
+{
+    return stream_used(me, me->head, me->tail);
+}
+
+static eos_s32_t eos_stream_empty_size(eos_stream_t *const me)
+{
+    return me->capacity - eos_stream_size(me);
+}
+
+/* The regions of size bytes from the index, split at the end of the memory. */
+static eos_u32_t eos_stream_span(eos_stream_t *const me, eos_u32_t index,
+                                 eos_u32_t size, eos_db_span_t *span)
+{
+    eos_u8_t *stream = (eos_u8_t *)me->data;
+    eos_u32_t offset = stream_offset(me, index);
+    eos_u32_t size_first = me->capacity - offset;
+    size_first = (size < size_first) ? size : size_first;
+
+    span->data[0] = &stream[offset];
+    span->size[0] = size_first;
+    span->data[1] = stream;
+    span->size[1] = size - size_first;
+
+    return size;
+}
+
+/* private event pool function ---------------------------------------------- */
+static void e_pool_init(eos_event_pool_t *const me)
+{
+    /* Link all the records into the free list. */
+    for (eos_u32_t i = 0; i < (EOS_MAX_EVENT_RECORD - 1); i++)
+    {
+        me->record[i].next = &me->record[i + 1];
+    }
+    me->record[EOS_MAX_EVENT_RECORD - 1].next = EOS_NULL;
+
+    me->free = &me->record[0];
+    me->count_free = EOS_MAX_EVENT_RECORD;
+    me->count_free_min = EOS_MAX_EVENT_RECORD;
+    me->count_exhausted = 0;
+}
+
+static eos_event_data_t *e_pool_get(eos_event_pool_t *const me)
+{
+    eos_event_record_t *record = me->free;
+
+    if (record == EOS_NULL)
+    {
+        me->count_exhausted ++;
+        return EOS_NULL;
+    }
+
+    me->free = record->next;
+    me->count_free --;
+    if (me->count_free < me->count_free_min)
+    {
+        me->count_free_min = me->count_free;
+    }
+
+    return &record->data;
+}
+
+static void e_pool_put(eos_event_pool_t *const me, eos_event_data_t *e_item)
+{
+    eos_event_record_t *record = (eos_event_record_t *)e_item;
+
+    /* If this assert is trigged, the event data is not from the pool. */
+    EOS_ASSERT(record >= &me->record[0] &&
+               record < &me->record[EOS_MAX_EVENT_RECORD]);
+
+    record->next = me->free;
+    me->free = record;
+    me->count_free ++;
+}
+
+/* private isr ring function ------------------------------------------------ */
+#if (EOS_SIZE_ISR_RING != 0)
+static ek_task_t isr_task;
+static eos_u32_t isr_task_stack[EOS_ISR_TASK_STACK_SIZE / 4];
+
+static void eos_isr_task_init(void)
+{
+    eos.isr_ring.head = 0;
+    eos.isr_ring.tail = 0;
+    eos.isr_ring.signaled = false;
+    eos.isr_ring.count_used_max = 0;
+    eos.isr_ring.count_overflow = 0;
+    eos_sem_init(&eos.isr_ring.sem, 0);
+
+    ek_task_init(&isr_task,
+                 eos_isr_task_entry,
+                 EOS_NULL,
+                 &isr_task_stack[0],
+                 sizeof(isr_task_stack),
+                 EOS_ISR_TASK_PRIO,
+                 EOS_TIMESLICE);
+    eos_task_startup((eos_task_handle_t)&isr_task);
+}
+
+/* The events recorded in ISR are given in the task context, so the ISR does not
+   disable the interrupt for the whole giving. */
+static void eos_isr_task_entry(void *parameter)
+{
+    eos_isr_ring_t *ring = &eos.isr_ring;
+    (void)parameter;
+
+    while (1)
+    {
+        eos_sem_take(&ring->sem, EOS_WAIT_FOREVER);
+        ring->signaled = false;
+
+        while (ring->tail != ring->head)
+        {
+            eos_u16_t index = ring->tail & (EOS_SIZE_ISR_RING - 1);
+            eos_isr_event_t e = ring->event[index];
+            ring->tail ++;
+
+            eos_event_give_(EOS_NULL, EOS_MAX_OBJECTS,
+                            EosEventGiveType_Publish, EOS_NULL, e.topic,
+                            EOS_NULL, e.value);
+        }
+    }
+}
+#endif
+
+/* private persistent key function ------------------------------------------ */
+#if (EOS_USE_DB_PERSIST != 0)
+/* The CRC-32 of the nibbles, for the small table. */
+static const eos_u32_t persist_crc_table[16] =
+{
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+    0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+    0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+/* Another persistent value key has the same hash value as the key. */
+static bool eos_db_persist_collide_(const char *key)
+{
+    eos_u16_t length;
+    eos_u32_t hash = eos_hash_time33_len(ch_type[EosObj_Event], key, &length);
+
+    for (eos_u16_t i = 0; i < EOS_MAX_OBJECTS; i ++)
+    {
+        eos_object_t *object = &eos.object[i];
+        if (object->key != (const char *)0 &&
+            object->type == EosObj_Event &&
+            (object->attribute & EOS_DB_ATTRIBUTE_VALUE) != 0 &&
+            (object->attribute & EOS_DB_ATTRIBUTE_PERSISTENT) != 0 &&
+            object->hash == hash &&
+            (object->key_len != length ||
+             memcmp(object->key, key, length) != 0))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* Mark the key with the interrupt disabled. The persist task is woken only
+   once until it starts to work. Nothing is marked before mounting. */
+static void eos_db_persist_mark_(eos_u32_t *bits, eos_u16_t e_id)
+{
+    eos_persist_t *me = &eos.persist;
+    if (me->flash == EOS_NULL)
+    {
+        return;
+    }
 
-    return (void *)((eos_u32_t)block + (eos_u32_t)sizeof(eos_heap_block_t));
+    bits[e_id >> 5] |= (1U << (e_id & 31));
+    if (me->signaled == false)
+    {
+        me->signaled = true;
+        eos_sem_release(&me->sem);
+    }
 }
 
-void eos_heap_free(eos_heap_t *const me, void * data)
+/* The keys written in the delay are saved in one batch, and the key written
+   many times is saved once with its last value. */
+static void eos_persist_task_entry(void *parameter)
 {
-    eos_heap_block_t *block_crt =
-        (eos_heap_block_t *)((eos_u32_t)data - sizeof(eos_heap_block_t));
+    eos_persist_t *me = &eos.persist;
+    (void)parameter;
 
-    /* Search for this block in the block-list. */
-    eos_heap_block_t *block = me->list;
-    eos_heap_block_t *block_last = EOS_NULL;
-    do
+    while (1)
     {
-        if (block->is_free == 0 && block == block_crt)
+        eos_sem_take(&me->sem, EOS_WAIT_FOREVER);
+        me->busy = true;
+        if (me->flush == false)
         {
-            break;
+            eos_task_delay_ms(EOS_PERSIST_DELAY_MS);
         }
-        else
+        me->signaled = false;
+
+        for (eos_u32_t i = 0; i < ((EOS_MAX_OBJECTS + 31) >> 5); i ++)
         {
-            block_last = block;
-            block = block->next;
+            register eos_base_t level = eos_hw_interrupt_disable();
+            eos_u32_t bits_load = me->load[i];
+            eos_u32_t bits_save = me->save[i];
+            me->load[i] = 0;
+            me->save[i] = 0;
+            eos_hw_interrupt_enable(level);
+
+            while (bits_load != 0)
+            {
+                eos_u16_t e_id = (i << 5) + __eos_ffs((int)bits_load) - 1;
+                bits_load &= (bits_load - 1);
+                persist_load(e_id);
+            }
+            while (bits_save != 0)
+            {
+                eos_u16_t e_id = (i << 5) + __eos_ffs((int)bits_save) - 1;
+                bits_save &= (bits_save - 1);
+                persist_save(e_id);
+            }
         }
-    } while (block != EOS_NULL);
 
-    /* Not found. */
-    if (block == EOS_NULL)
-    {
-        me->error_id = 4;
-        return;
+        me->flush = false;
+        me->busy = false;
     }
+}
 
-    block->is_free = 1;
-    /* Check the block can be combined with the front one. */
-    if (block_last != (eos_heap_block_t *)NULL && block_last->is_free == 1)
-    {
-        block_last->size += (block->size + sizeof(eos_heap_block_t));
-        block_last->next = block->next;
-        block = block_last;
-    }
+static eos_u32_t persist_crc(eos_u32_t crc, const void *data, eos_u32_t size)
+{
+    const eos_u8_t *byte = (const eos_u8_t *)data;
 
-    /* Check the block can be combined with the later one. */
-    if (block->next != (eos_heap_block_t *)EOS_NULL && block->next->is_free == 1)
+    crc = ~crc;
+    for (eos_u32_t i = 0; i < size; i ++)
     {
-        block->size += (block->next->size + (eos_u32_t)sizeof(eos_heap_block_t));
-        block->next = block->next->next;
-        block->is_free = 1;
+        crc ^= byte[i];
+        crc = (crc >> 4) ^ persist_crc_table[crc & 0x0F];
+        crc = (crc >> 4) ^ persist_crc_table[crc & 0x0F];
     }
 
-    me->error_id = 0;
+    return ~crc;
 }
 
-/* private hash function ---------------------------------------------------- */
-static char ch_type[EosObj_Max] = { 'A', 'E', 'T' };
+static inline eos_u32_t persist_align(eos_u32_t size)
+{
+    eos_u32_t align = eos.persist.flash->align;
 
-static eos_u32_t eos_hash_time33(char ch_type, const char *string)
+    return ((size + align - 1) & ~(align - 1));
+}
+
+static void persist_read(eos_u32_t addr, void *data, eos_u32_t size)
 {
-    eos_u32_t hash = 5381;
-    hash += (hash << 5) + ch_type;
-    while (*string)
-    {
-        hash += (hash << 5) + (*string++);
-    }
+    eos_s32_t ret = eos.persist.flash->read(addr, data, size);
+    EOS_ASSERT(ret == 0);
+    (void)ret;
+}
 
-    return (eos_u32_t)(hash & (0x7fffffff));
+static void persist_write(eos_u32_t addr, const void *data, eos_u32_t size)
+{
+    eos_s32_t ret = eos.persist.flash->write(addr, data, size);
+    EOS_ASSERT(ret == 0);
+    (void)ret;
+    eos.persist.info.bytes_flash += size;
 }
 
-static eos_u16_t eos_hash_insert(eos_u8_t obj_type, const char *string)
+static bool persist_sector_used(eos_u16_t sector)
 {
-    eos_u16_t index = 0;
+    eos_u32_t magic;
+    persist_read(sector * eos.persist.flash->sector_size,
+                 &magic, sizeof(magic));
 
-    /* Calculate the hash value of the string. */
-    eos_u32_t hash = eos_hash_time33(ch_type[obj_type], string);
-    eos_u16_t index_init = hash % eos.prime_max;
+    return (magic == EOS_PERSIST_MAGIC_SECTOR);
+}
 
-    for (eos_u16_t i = 0; i < (EOS_MAX_OBJECTS / 2 + 1); i++)
+/* The sector becomes the head. It is erased first if it is not blank, such as
+   the unknown data, or the erasing cut by a power loss. */
+static void persist_sector_open(eos_u16_t sector)
+{
+    eos_persist_t *me = &eos.persist;
+    const eos_flash_t *flash = me->flash;
+    eos_u32_t addr = sector * flash->sector_size;
+    eos_u32_t chunk[EOS_PERSIST_CHUNK / 4];
+
+    bool blank = true;
+    for (eos_u32_t offset = 0;
+         offset < flash->sector_size && blank == true;
+         offset += EOS_PERSIST_CHUNK)
     {
-        for (eos_s8_t j = -1; j <= 1; j += 2)
+        persist_read(addr + offset, chunk, EOS_PERSIST_CHUNK);
+        for (eos_u32_t i = 0; i < (EOS_PERSIST_CHUNK / 4); i ++)
         {
-            index = index_init + i * j + 2 * (eos_s16_t)EOS_MAX_OBJECTS;
-            index %= EOS_MAX_OBJECTS;
-
-            /* Find the empty object. */
-            if (eos.object[index].key == (const char *)0)
-            {
-                eos.object[index].key = string;
-                goto exit;
-            }
-            if (strcmp(eos.object[index].key, string) == 0 &&
-                eos.object[index].type == obj_type)
+            if (chunk[i] != EOS_PERSIST_ERASED)
             {
-                goto exit;
+                blank = false;
+                break;
             }
         }
-
-        /* Ensure the finding speed is not slow. */
-        if (i >= EOS_MAX_HASH_SEEK_TIMES)
-        {
-            /* If this assert is trigged, you need to enlarge the hash table size. */
-            EOS_ASSERT(0);
-        }
+    }
+    if (blank == false)
+    {
+        eos_s32_t ret = flash->erase(addr);
+        EOS_ASSERT(ret == 0);
+        (void)ret;
+        me->info.erases ++;
     }
 
-exit:
-    return index;
+    memset(chunk, 0xFF, sizeof(chunk));
+    eos_persist_sector_t *header = (eos_persist_sector_t *)chunk;
+    header->magic = EOS_PERSIST_MAGIC_SECTOR;
+    header->seq = me->seq;
+    persist_write(addr, chunk, persist_align(sizeof(eos_persist_sector_t)));
+
+    me->head = sector;
+    me->offset = persist_align(sizeof(eos_persist_sector_t));
 }
 
-static eos_u16_t eos_hash_get_index(eos_u8_t obj_type, const char *string)
+/* Walk through the record headers of one sector, and return the offset after
+   the last record. A header cut by a power loss is skipped by itself, and the
+   blank header ends the sector. */
+static eos_u32_t persist_sector_walk(eos_u16_t sector, eos_u8_t mode,
+                                     eos_persist_entry_t *entry)
 {
-    eos_u16_t index = 0;
+    const eos_flash_t *flash = eos.persist.flash;
+    eos_u32_t addr_sector = sector * flash->sector_size;
+    eos_u32_t size_header = persist_align(sizeof(eos_persist_record_t));
+    eos_u32_t offset = persist_align(sizeof(eos_persist_sector_t));
 
-    /* Calculate the hash value of the string. */
-    eos_u32_t hash = eos_hash_time33(ch_type[obj_type], string);
-    eos_u16_t index_init = hash % eos.prime_max;
-
-    for (eos_u16_t i = 0; i < (EOS_MAX_OBJECTS / 2 + 1); i++)
+    while ((offset + size_header) <= flash->sector_size)
     {
-        for (eos_s8_t j = -1; j <= 1; j += 2)
+        eos_u32_t addr = addr_sector + offset;
+        eos_persist_record_t record;
+        persist_read(addr, &record, sizeof(record));
+        if (record.magic == EOS_PERSIST_ERASED)
+        {
+            break;
+        }
+        if (record.magic != EOS_PERSIST_MAGIC_RECORD ||
+            record.size > EOS_SIZE_PERSIST_VALUE ||
+            (offset + size_header + persist_align(record.size)) >
+                flash->sector_size)
         {
-            index = index_init + i * j + 2 * (eos_s16_t)EOS_MAX_OBJECTS;
-            index %= EOS_MAX_OBJECTS;
+            offset += size_header;
+            continue;
+        }
+        offset += (size_header + persist_align(record.size));
 
-            if (eos.object[index].key != (const char *)0 &&
-                eos.object[index].type == obj_type &&
-                strcmp(eos.object[index].key, string) == 0)
+        if (mode == PersistWalk_Index)
+        {
+            persist_index(record.hash, addr);
+            eos.persist.info.records ++;
+        }
+        else if (mode == PersistWalk_Find)
+        {
+            if (record.hash == entry->hash && persist_check(addr, &record))
             {
-                goto exit;
+                entry->addr = addr;
+            }
+        }
+        else
+        {
+            /* Only the newest good record of the key is moved. The newer one
+               in the head may be cut by a power loss in the last collecting,
+               and then the good one in this sector is moved instead. */
+            entry = persist_entry(record.hash);
+            if (entry == EOS_NULL)
+            {
+                continue;
+            }
+            if (entry->addr != addr)
+            {
+                if (mode != PersistWalk_Resume ||
+                    (entry->addr / flash->sector_size) != eos.persist.head ||
+                    persist_check(entry->addr, &record) ||
+                    !persist_recover(entry))
+                {
+                    continue;
+                }
+            }
+            else if (!persist_check(addr, &record) && !persist_recover(entry))
+            {
+                continue;
+            }
+            if ((entry->addr / flash->sector_size) == sector)
+            {
+                persist_check(entry->addr, &record);
+                persist_record_write(&record,
+                                     entry->addr + size_header, EOS_NULL);
             }
         }
+    }
+
+    return offset;
+}
 
-        /* Ensure the finding speed is not slow. */
-        if (i >= EOS_MAX_HASH_SEEK_TIMES)
+static eos_persist_entry_t *persist_entry(eos_u32_t hash)
+{
+    for (eos_u16_t i = 0; i < eos.persist.count; i ++)
+    {
+        if (eos.persist.entry[i].hash == hash)
         {
-            index = EOS_MAX_OBJECTS;
-            goto exit;
+            return &eos.persist.entry[i];
         }
     }
 
-exit:
-    return index;
+    return EOS_NULL;
+}
+
+static void persist_index(eos_u32_t hash, eos_u32_t addr)
+{
+    eos_persist_t *me = &eos.persist;
+    eos_persist_entry_t *entry = persist_entry(hash);
+    if (entry == EOS_NULL)
+    {
+        /* If this assert is trigged, enlarge EOS_MAX_PERSIST_KEYS. */
+        EOS_ASSERT(me->count < EOS_MAX_PERSIST_KEYS);
+        entry = &me->entry[me->count ++];
+        entry->hash = hash;
+    }
+    entry->addr = addr;
 }
 
-static bool eos_hash_existed(eos_u8_t obj_type, const char *string)
+/* Read the header and check the CRC of the whole record, by chunks. */
+static bool persist_check(eos_u32_t addr, eos_persist_record_t *record)
 {
-    bool ret = false;
+    eos_u32_t chunk[EOS_PERSIST_CHUNK / 4];
 
-    /* Calculate the hash value of the string. */
-    eos_u32_t hash = eos_hash_time33(ch_type[obj_type], string);
-    eos_u16_t index_init = hash % eos.prime_max;
+    persist_read(addr, record, sizeof(eos_persist_record_t));
+    if (record->magic != EOS_PERSIST_MAGIC_RECORD ||
+        record->size > EOS_SIZE_PERSIST_VALUE)
+    {
+        return false;
+    }
 
-    for (eos_u16_t i = 0; i < (EOS_MAX_OBJECTS / 2 + 1); i++)
+    eos_u32_t crc = persist_crc(0, &record->hash,
+                                sizeof(record->hash) + sizeof(record->size));
+    addr += persist_align(sizeof(eos_persist_record_t));
+    for (eos_u32_t offset = 0; offset < record->size;
+         offset += EOS_PERSIST_CHUNK)
     {
-        for (eos_s8_t j = -1; j <= 1; j += 2)
-        {
-            eos_u16_t index = index_init + i * j + 2 * (eos_s16_t)EOS_MAX_OBJECTS;
-            index %= EOS_MAX_OBJECTS;
+        eos_u32_t size = record->size - offset;
+        size = (size > EOS_PERSIST_CHUNK) ? EOS_PERSIST_CHUNK : size;
+        persist_read(addr + offset, chunk, size);
+        crc = persist_crc(crc, chunk, size);
+    }
 
-            if (eos.object[index].key != (const char *)0 &&
-                eos.object[index].type == obj_type &&
-                strcmp(eos.object[index].key, string) == 0)
-            {
-                ret = true;
-                goto exit;
-            }
-        }
+    return (crc == record->crc);
+}
+
+/* Find the newest good record of the key in all the sectors. The key without
+   any good record is removed from the index. */
+static bool persist_recover(eos_persist_entry_t *entry)
+{
+    eos_persist_t *me = &eos.persist;
 
-        /* Ensure the finding speed is not slow. */
-        if (i >= EOS_MAX_HASH_SEEK_TIMES)
+    entry->addr = EOS_PERSIST_ERASED;
+    for (eos_u16_t i = 1; i <= me->flash->sector_count; i ++)
+    {
+        eos_u16_t sector = (me->head + i) % me->flash->sector_count;
+        if (persist_sector_used(sector))
         {
-            goto exit;
+            persist_sector_walk(sector, PersistWalk_Find, entry);
         }
     }
+    if (entry->addr != EOS_PERSIST_ERASED)
+    {
+        return true;
+    }
 
-exit:
-    return ret;
+    *entry = me->entry[-- me->count];
+
+    return false;
 }
 
-/* private stream function -------------------------------------------------- */
-static eos_s32_t eos_stream_init(eos_stream_t *const me, void *memory, eos_u32_t capacity)
+/* The live records of the oldest sector are moved into the head, which is
+   opened just now, so they always fit in it. */
+static void persist_collect(eos_u16_t sector, eos_u8_t mode)
 {
-    me->data = memory;
-    me->capacity = capacity;
-    me->head = 0;
-    me->tail = 0;
-    me->empty = true;
+    eos_persist_t *me = &eos.persist;
 
-    return Stream_OK;
+    persist_sector_walk(sector, mode, EOS_NULL);
+
+    eos_s32_t ret = me->flash->erase(sector * me->flash->sector_size);
+    EOS_ASSERT(ret == 0);
+    (void)ret;
+    me->info.erases ++;
+    me->info.collects ++;
 }
 
-static eos_s32_t eos_stream_push(eos_stream_t *const me, void * data, eos_u32_t size)
+/* The head moves to the next sector, which is always erased. If the sector
+   after the new head is used, it is the oldest one, and it is collected, so
+   one sector is always erased for the next moving. */
+static void persist_head_next(void)
 {
-    if (eos_stream_full(me))
+    eos_persist_t *me = &eos.persist;
+
+    me->seq ++;
+    persist_sector_open((me->head + 1) % me->flash->sector_count);
+
+    eos_u16_t oldest = (me->head + 1) % me->flash->sector_count;
+    if (persist_sector_used(oldest))
     {
-        return Stream_Full;
+        persist_collect(oldest, PersistWalk_Collect);
     }
-    if (eos_stream_empty_size(me) < size)
+}
+
+/* Write the record at the head, with the value from the memory, or from the
+   flash for moving the record. The header is programmed first. */
+static void persist_record_write(const eos_persist_record_t *record,
+                                 eos_u32_t addr_value, const void *value)
+{
+    eos_persist_t *me = &eos.persist;
+    eos_u32_t chunk[EOS_PERSIST_CHUNK / 4];
+    eos_u32_t size_header = persist_align(sizeof(eos_persist_record_t));
+    eos_u32_t size_value = persist_align(record->size);
+    eos_u32_t addr = me->head * me->flash->sector_size + me->offset;
+
+    /* If this assert is trigged, the flash is too small for the keys. */
+    EOS_ASSERT((me->offset + size_header + size_value) <=
+               me->flash->sector_size);
+
+    memset(chunk, 0xFF, sizeof(chunk));
+    memcpy(chunk, record, sizeof(eos_persist_record_t));
+    persist_write(addr, chunk, size_header);
+    addr += size_header;
+
+    if (value == EOS_NULL)
     {
-        return Stream_NotEnough;
+        for (eos_u32_t offset = 0; offset < size_value;
+             offset += EOS_PERSIST_CHUNK)
+        {
+            eos_u32_t size = size_value - offset;
+            size = (size > EOS_PERSIST_CHUNK) ? EOS_PERSIST_CHUNK : size;
+            persist_read(addr_value + offset, chunk, size);
+            persist_write(addr + offset, chunk, size);
+        }
     }
-
-    eos_u8_t *stream = (eos_u8_t *)me->data;
-    for (int i = 0; i < size; i++)
+    else
     {
-        stream[me->head] = ((eos_u8_t *)data)[i];
-        me->head = ((me->head + 1) % me->capacity);
+        /* The last part of the value is padded to the programming unit. */
+        eos_u32_t size_body = record->size & ~(me->flash->align - 1U);
+        if (size_body != 0)
+        {
+            persist_write(addr, value, size_body);
+        }
+        if (size_body != size_value)
+        {
+            memset(chunk, 0xFF, sizeof(chunk));
+            memcpy(chunk, (const eos_u8_t *)value + size_body,
+                   record->size - size_body);
+            persist_write(addr + size_body, chunk, size_value - size_body);
+        }
     }
-    me->empty = false;
 
-    return Stream_OK;
+    persist_index(record->hash, addr - size_header);
+    me->offset += (size_header + size_value);
 }
 
-static eos_s32_t eos_stream_pull_pop(eos_stream_t *const me, void * data, eos_u32_t size)
+/* Append the value, or the copy of the newest record of the key without the
+   value. */
+static void persist_append(eos_u32_t hash, const void *value, eos_u32_t size)
 {
-    if (me->empty)
+    eos_persist_t *me = &eos.persist;
+    eos_persist_record_t record;
+    eos_u32_t size_record = persist_align(sizeof(eos_persist_record_t)) +
+                            persist_align(size);
+
+    /* The new head may be filled by the moved records, so it moves again. */
+    for (eos_u16_t i = 0;
+         (me->offset + size_record) > me->flash->sector_size;
+         i ++)
     {
-        return 0;
+        /* If this assert is trigged, the flash is too small for the keys. */
+        EOS_ASSERT(i < me->flash->sector_count);
+        persist_head_next();
     }
 
-    eos_u32_t size_stream = eos_stream_size(me);
-    size = (size_stream < size) ? size_stream : size;
+    if (value == EOS_NULL)
+    {
+        eos_persist_entry_t *entry = persist_entry(hash);
+        persist_check(entry->addr, &record);
+        persist_record_write(&record,
+                             entry->addr +
+                             persist_align(sizeof(eos_persist_record_t)),
+                             EOS_NULL);
+        return;
+    }
 
-    eos_u8_t *stream = (eos_u8_t *)me->data;
-    for (int i = 0; i < size; i++)
+    record.magic = EOS_PERSIST_MAGIC_RECORD;
+    record.hash = hash;
+    record.size = size;
+    record.crc = persist_crc(0, &record.hash,
+                             sizeof(record.hash) + sizeof(record.size));
+    record.crc = persist_crc(record.crc, value, size);
+    persist_record_write(&record, 0, value);
+}
+
+/* The value of the key is left as it is without any good record, or if the
+   size of the key is changed. The sequence of the lock-free value grows by
+   two, so the reader copying meanwhile copies again. */
+static void persist_load(eos_u16_t e_id)
+{
+    eos_persist_t *me = &eos.persist;
+    eos_persist_record_t record;
+
+    eos_persist_entry_t *entry = persist_entry(eos.object[e_id].hash);
+    if (entry == EOS_NULL)
     {
-        ((eos_u8_t *)data)[i] = stream[me->tail];
-        me->tail = (me->tail + 1) % me->capacity;
+        return;
     }
-    
-    if (me->tail == me->head)
+    if (!persist_check(entry->addr, &record))
     {
-        me->tail = 0;
-        me->head = 0;
-        me->empty = true;
+        if (!persist_recover(entry))
+        {
+            return;
+        }
+        persist_check(entry->addr, &record);
     }
+    if (record.size != eos.object[e_id].size)
+    {
+        return;
+    }
+    persist_read(entry->addr + persist_align(sizeof(eos_persist_record_t)),
+                 me->value, record.size);
 
-    return size;
+    register eos_base_t level = eos_hw_interrupt_disable();
+    if ((eos.object[e_id].attribute & EOS_DB_ATTRIBUTE_PERSISTENT) == 0 ||
+        eos.object[e_id].size != record.size)
+    {
+        eos_hw_interrupt_enable(level);
+        return;
+    }
+    /* The loaded version of the buffered value is committed with no region,
+       so it is neither dirty nor saved again. */
+    if (eos_db_buffered_(e_id))
+    {
+        eos_hw_interrupt_enable(level);
+        eos_u32_t index = eos_db_version_reserve_(e_id);
+        eos_db_copy_(eos_db_version_data_(e_id, index), me->value, record.size);
+        eos_db_version_commit_(e_id, index, 0);
+        return;
+    }
+    eos_db_copy_(eos.event[e_id].data.value, me->value, record.size);
+    eos_db_tail_(e_id)->seq += 2;
+    eos_hw_interrupt_enable(level);
 }
 
-static bool eos_stream_full(eos_stream_t *const me)
+static void persist_save(eos_u16_t e_id)
 {
-    eos_s32_t size = me->head - me->tail;
-    if (size < 0)
+    eos_persist_t *me = &eos.persist;
+
+    /* The key may be unregistered after it is marked. */
+    register eos_base_t level = eos_hw_interrupt_disable();
+    eos_u8_t attribute = eos.object[e_id].attribute;
+    eos_u32_t size = eos.object[e_id].size;
+    eos_u32_t hash = eos.object[e_id].hash;
+    if ((attribute & EOS_DB_ATTRIBUTE_VALUE) == 0 ||
+        (attribute & EOS_DB_ATTRIBUTE_PERSISTENT) == 0)
+    {
+        eos_hw_interrupt_enable(level);
+        return;
+    }
+    if ((attribute & EOS_DB_ATTRIBUTE_LOCK_FREE) != 0)
+    {
+        eos_hw_interrupt_enable(level);
+        eos_db_value_read_(e_id, me->value, 0, size);
+    }
+    else if (eos_db_buffered_(e_id))
     {
-        size += me->capacity;
+        eos_hw_interrupt_enable(level);
+        eos_db_version_read_(e_id, me->value, 0, size);
+    }
+    else
+    {
+        eos_db_copy_(me->value, eos.event[e_id].data.value, size);
+        eos_hw_interrupt_enable(level);
     }
 
-    return (size == 0 && me->empty == false) ? true : false;
+    persist_append(hash, me->value, size);
+    me->info.saves ++;
+    me->info.bytes_value += size;
 }
+#endif
 
-static eos_s32_t eos_stream_size(eos_stream_t *const me)
+/* private static registry function ---------------------------------------- */
+#if (EOS_USE_STATIC_REG != 0)
+/* The stream head is placed in the memory of the static key. */
+typedef char eos_reg_stream_head_check_
+    [(sizeof(eos_stream_t) <= EOS_DB_STREAM_HEAD_SIZE) ? 1 : -1];
+typedef char eos_reg_stream_reader_check_
+    [(sizeof(eos_stream_reader_t) <= EOS_DB_STREAM_READER_SIZE) ? 1 : -1];
+/* So are the tail of the value, and the versions of the buffered value. */
+typedef char eos_reg_value_tail_check_
+    [((sizeof(eos_db_tail_t) + sizeof(eos_db_version_t)) <=
+      EOS_DB_STREAM_HEAD_SIZE) ? 1 : -1];
+
+/* The registry is walked three times, for the database keys, the tasks and the
+   subscriptions in turn. The empty entries are skipped, as the padding between
+   sections. */
+static void eos_reg_init(void)
 {
-    if (me->empty == true)
+    for (eos_u8_t pass = 0; pass < 3; pass ++)
     {
-        return 0;
-    }
+        for (const eos_reg_t *reg = EOS_REG_BEGIN; reg < EOS_REG_END; reg ++)
+        {
+            if (reg->kind == EosReg_None)
+            {
+                continue;
+            }
 
-    eos_s32_t size = me->head - me->tail;
-    if (size <= 0)
-    {
-        size += me->capacity;
+            eos_u8_t pass_kind = (reg->kind == EosReg_Db) ? 0 :
+                                 (reg->kind == EosReg_Sub) ? 2 : 1;
+            if (pass_kind != pass)
+            {
+                continue;
+            }
+
+            if (reg->kind == EosReg_Db)
+            {
+                /* If this assert is trigged, the persistent key has the
+                   same hash value as another one, rename one of them. */
+                eos_err_t ret = eos_db_register_(reg->name, reg->size,
+                                                 reg->attribute, reg->object);
+                EOS_ASSERT_NAME(ret == EOS_EOK, reg->name);
+                (void)ret;
+            }
+            else if (reg->kind == EosReg_Task)
+            {
+                eos_task_init((eos_task_t *)reg->object, reg->name,
+                              (void (*)(void *))reg->func, reg->parameter,
+                              reg->stack, reg->size, reg->priority);
+                eos_task_startup((eos_task_t *)reg->object);
+            }
+            else if (reg->kind == EosReg_Reactor)
+            {
+                eos_reactor_init((eos_reactor_t *)reg->object, reg->name,
+                                 reg->priority, reg->stack, reg->size);
+                eos_reactor_start((eos_reactor_t *)reg->object,
+                                  (eos_event_handler)reg->func);
+            }
+#if (EOS_USE_SM_MODE != 0)
+            else if (reg->kind == EosReg_Sm)
+            {
+                eos_sm_init((eos_sm_t *)reg->object, reg->name,
+                            reg->priority, reg->stack, reg->size);
+                eos_sm_start((eos_sm_t *)reg->object,
+                             (eos_state_handler)reg->func);
+            }
+#endif
+            else if (reg->kind == EosReg_Sub)
+            {
+                eos_u32_t t_id = eos_get_task_id(reg->name);
+                eos_event_sub_(eos_obj_task_(t_id),
+                               eos_topic_get(reg->topic));
+            }
+        }
     }
+}
+#endif
 
-    return size;
+/* private mailbox function ------------------------------------------------- */
+static inline bool mailbox_is_empty(eos_mailbox_t *mailbox)
+{
+    return (mailbox->head == mailbox->tail) ? true : false;
 }
 
-static eos_s32_t eos_stream_empty_size(eos_stream_t *const me)
+static inline bool mailbox_is_full(eos_mailbox_t *mailbox)
 {
-    return me->capacity - eos_stream_size(me);
+    eos_u16_t count = (eos_u16_t)(mailbox->head - mailbox->tail);
+
+    return (count >= EOS_SIZE_MAILBOX) ? true : false;
+}
+
+static inline void mailbox_push(eos_mailbox_t *mailbox, eos_event_data_t *e_item)
+{
+    mailbox->e_item[mailbox->head & (EOS_SIZE_MAILBOX - 1)] = e_item;
+    mailbox->head ++;
+}
+
+static inline eos_event_data_t *mailbox_pop(eos_mailbox_t *mailbox)
+{
+    eos_event_data_t *e_item;
+
+    e_item = mailbox->e_item[mailbox->tail & (EOS_SIZE_MAILBOX - 1)];
+    mailbox->tail ++;
+
+    return e_item;
+}
+
+/* Take the oldest event in the set out of the mailbox, and the later ones are
+   moved forward to keep their order. */
+static eos_event_data_t *mailbox_take_(eos_mailbox_t *mailbox,
+                                        const eos_wait_set_t *set)
+{
+    for (eos_u16_t i = mailbox->tail; i != mailbox->head; i ++)
+    {
+        eos_event_data_t *e_item = mailbox->e_item[i & (EOS_SIZE_MAILBOX - 1)];
+        if ((set->data[e_item->id >> 5] & (1U << (e_item->id & 31))) == 0)
+        {
+            continue;
+        }
+
+        for (eos_u16_t j = i; (eos_u16_t)(j + 1) != mailbox->head; j ++)
+        {
+            mailbox->e_item[j & (EOS_SIZE_MAILBOX - 1)] =
+                mailbox->e_item[(j + 1) & (EOS_SIZE_MAILBOX - 1)];
+        }
+        mailbox->head --;
+
+        return e_item;
+    }
+
+    return EOS_NULL;
 }
 
 /* private owner function --------------------------------------------------- */
 static inline bool owner_is_occupied(eos_owner_t *owner, eos_u32_t t_index)
 {
-    if (owner->data[t_index >> 3] & (1 << (t_index % 8)))
+    if (owner->data[t_index >> 5] & (1U << (t_index & 31)))
     {
         return true;
     }
@@ -2098,11 +5354,11 @@ static inline void owner_set_bit(eos_owner_t *owner, eos_u32_t t_id, bool status
 {
     if (status == true)
     {
-        owner->data[t_id >> 3] |= (1 << (t_id % 8));
+        owner->data[t_id >> 5] |= (1U << (t_id & 31));
     }
     else
     {
-        owner->data[t_id >> 3] &= ~(1 << (t_id % 8));
+        owner->data[t_id >> 5] &= ~(1U << (t_id & 31));
     }
 }
 
@@ -64,14 +64,82 @@ EventOS Default Configuration
 #define EOS_USE_TIME_EVENT                      0
 #endif
 
+#ifndef EOS_MAX_TIMERS
+#define EOS_MAX_TIMERS                          16
+#endif
+
 #ifndef EOS_USE_EVENT_DATA
 #define EOS_USE_EVENT_DATA                      0
 #endif
 
+#ifndef EOS_USE_TOPIC_TABLE
+#define EOS_USE_TOPIC_TABLE                     0
+#endif
+
+#ifndef EOS_USE_STATIC_REG
+#define EOS_USE_STATIC_REG                      0
+#endif
+
+#ifndef EOS_USE_HEAP_TLSF
+#define EOS_USE_HEAP_TLSF                       0
+#endif
+
+#ifndef EOS_DB_VERSIONS
+#define EOS_DB_VERSIONS                         3
+#endif
+
+#ifndef EOS_SIZE_EVENT_BUF
+#define EOS_SIZE_EVENT_BUF                      1024
+#endif
+
+#ifndef EOS_MAX_EVENT_RECORD
+#define EOS_MAX_EVENT_RECORD                    64
+#endif
+
+#ifndef EOS_SIZE_MAILBOX
+#define EOS_SIZE_MAILBOX                        32
+#endif
+
+#ifndef EOS_SIZE_ISR_RING
+#define EOS_SIZE_ISR_RING                       0
+#endif
+
+#ifndef EOS_ISR_TASK_PRIO
+#define EOS_ISR_TASK_PRIO                       0
+#endif
+
+#ifndef EOS_ISR_TASK_STACK_SIZE
+#define EOS_ISR_TASK_STACK_SIZE                 512
+#endif
+
 #ifndef EOS_USE_EVENT_BRIDGE
 #define EOS_USE_EVENT_BRIDGE                    0
 #endif
 
+#ifndef EOS_USE_DB_PERSIST
+#define EOS_USE_DB_PERSIST                      0
+#endif
+
+#ifndef EOS_MAX_PERSIST_KEYS
+#define EOS_MAX_PERSIST_KEYS                    32
+#endif
+
+#ifndef EOS_SIZE_PERSIST_VALUE
+#define EOS_SIZE_PERSIST_VALUE                  256
+#endif
+
+#ifndef EOS_PERSIST_DELAY_MS
+#define EOS_PERSIST_DELAY_MS                    100
+#endif
+
+#ifndef EOS_PERSIST_TASK_PRIO
+#define EOS_PERSIST_TASK_PRIO                   (EOS_MAX_PRIORITY - 2)
+#endif
+
+#ifndef EOS_PERSIST_TASK_STACK_SIZE
+#define EOS_PERSIST_TASK_STACK_SIZE             512
+#endif
+
 /* -----------------------------------------------------------------------------
 Includes
 ----------------------------------------------------------------------------- */
@@ -100,6 +168,28 @@ eos_u8_t eos_interrupt_get_nest(void);
 eos_base_t eos_hw_interrupt_disable(void);
 void eos_hw_interrupt_enable(eos_base_t level);
 
+/*
+ * The information of the object table. Every object type has its own hash
+ * index. probe[i] is the count of the objects found at the i-th seeking, so
+ * EOS_MAX_OBJECTS and EOS_MAX_HASH_SEEK_TIMES can be sized from the data.
+ * The memory of the object table is given in two parts, the dense part seeked
+ * by the hash lookup, and the blocks of events, tasks and timers.
+ */
+typedef struct eos_hash_info
+{
+    eos_u16_t capacity;
+    eos_u16_t count_task;
+    eos_u16_t count_event;
+    eos_u16_t count_timer;
+    eos_u16_t count_known;                  // The keys in the topic table.
+    eos_u16_t probe[EOS_MAX_HASH_SEEK_TIMES + 1];
+    eos_u16_t probe_max;                    // The longest seeking.
+    eos_u32_t ram_object;                   // Bytes of the hashed objects.
+    eos_u32_t ram_block;                    // Bytes of the object blocks.
+} eos_hash_info_t;
+
+void eos_hash_info(eos_hash_info_t * const info);
+
 /* -----------------------------------------------------------------------------
 Task
 ----------------------------------------------------------------------------- */
@@ -153,6 +243,15 @@ typedef struct eos_timer *eos_timer_handle_t;
 #define EOS_TASK_CTRL_INFO             0x03                /**< Get task information. */
 #define EOS_TASK_CTRL_BIND_CPU         0x04                /**< Set task bind cpu. */
 
+/*
+ * The set of the events that one task waits for, a bitmap indexed by the topic
+ * handle. The waiting task is only woken up by the events in the set.
+ */
+typedef struct eos_wait_set
+{
+    eos_u32_t data[(EOS_MAX_OBJECTS + 31) >> 5];
+} eos_wait_set_t;
+
 typedef struct eos_task
 {
 #if (EOS_USE_3RD_KERNEL == 0)
@@ -163,8 +262,7 @@ typedef struct eos_task
     eos_sem_t sem;
     eos_u16_t index;
     bool event_recv_disable;
-    bool wait_specific_event;
-    const char *event_wait;
+    const eos_wait_set_t *wait_set;         // The set in waiting, or NULL.
 } eos_task_t;
 
 typedef eos_task_t *eos_task_handle_t;
@@ -177,6 +275,8 @@ typedef struct eos_event
     const char *topic;                      // The event topic.
     eos_u32_t eid                    : 16;   // The event ID.
     eos_u32_t size                   : 16;   // The event content's size.
+    const void *data;                       // The payload, or NULL.
+    eos_u32_t value;                        // The inline value.
 } eos_event_t;
 
 /*
@@ -207,6 +307,12 @@ eos_u8_t eos_task_get_priority(eos_task_handle_t task);
 bool eos_task_wait_specific_event(eos_event_t * const e_out,
                                     const char *topic, eos_s32_t time_ms);
 bool eos_task_wait_event(eos_event_t * const e_out, eos_s32_t time_ms);
+/*
+ * Wait for any event in the set. The events not in the set are kept in the
+ * mailbox in their order, and do not wake up the task.
+ */
+bool eos_task_wait_any(eos_event_t * const e_out,
+                        const eos_wait_set_t *set, eos_s32_t time_ms);
 
 /* -----------------------------------------------------------------------------
 Timer
@@ -264,7 +370,71 @@ eos_err_t eos_mutex_release(eos_mutex_handle_t mutex);
 #endif
 
 /* Event interface ---------------------------------------------------------- */
+/*
+ * The topic handle, which is the index of the event in the object table. It is
+ * got once by eos_topic_get(), and used in the hot path without any hashing.
+ */
+typedef eos_u16_t eos_topic_t;
+
+eos_topic_t eos_topic_get(const char *topic);
+eos_topic_t eos_topic_get_hashed(const char *topic, eos_u32_t hash);
+eos_u32_t eos_get_task_id(const char *task);
+
+void eos_wait_set_clear(eos_wait_set_t * const set);
+void eos_wait_set_add(eos_wait_set_t * const set, eos_topic_t topic);
+
+/*
+ * The information of the event record pool. When the pool is exhausted, the
+ * event is dropped and counted in exhausted. When the mailbox of one task is
+ * full, the event is dropped for this task only, and counted in mailbox_full.
+ */
+typedef struct eos_event_pool_info
+{
+    eos_u16_t capacity;
+    eos_u16_t free;
+    eos_u16_t free_min;                     // The low-water mark of free.
+    eos_u32_t exhausted;                    // The count of dropped events.
+    eos_u32_t mailbox_full;                 // The count of dropped deliveries.
+} eos_event_pool_info_t;
+
+void eos_event_pool_info(eos_event_pool_info_t * const info);
+
+/*
+ * EOS_TOPIC("Topic") gets the topic handle by the hash value calculated in the
+ * compiling time, so the topic string is only hashed once in the registration,
+ * and later only compared with the key found. The hash is the same time33 hash
+ * in the object table, and the topics with the same hash value are different
+ * objects, told apart by the string. The topic should be a string literal. In
+ * C, topics longer than EOS_TOPIC_HASH_LEN are hashed in the running time.
+ */
+#define EOS_TOPIC_HASH_LEN                  32
+#define EOS_TOPIC_HASH_SEED                 ((5381U * 33U) + 'E')
+
+#if !defined(__cplusplus)
+#define EOS_TOPIC(topic_)                                                      \
+    ((sizeof("" topic_) - 1 > EOS_TOPIC_HASH_LEN) ?                            \
+        eos_topic_get(topic_) :                                                \
+        eos_topic_get_hashed(topic_, EOS_TOPIC_HASH_(topic_)))
+#endif
+
+#define EOS_TOPIC_HASH_(s_)                                                    \
+    (EOS_HASH_16_(s_, 16, EOS_HASH_16_(s_, 0, EOS_TOPIC_HASH_SEED)) &          \
+        0x7fffffffU)
+#define EOS_HASH_16_(s_, i_, h_)                                               \
+    EOS_HASH_4_(s_, (i_) + 12, EOS_HASH_4_(s_, (i_) + 8,                       \
+    EOS_HASH_4_(s_, (i_) + 4, EOS_HASH_4_(s_, (i_), h_))))
+#define EOS_HASH_4_(s_, i_, h_)                                                \
+    EOS_HASH_STEP_(s_, (i_) + 3, EOS_HASH_STEP_(s_, (i_) + 2,                  \
+    EOS_HASH_STEP_(s_, (i_) + 1, EOS_HASH_STEP_(s_, (i_), h_))))
+/* The hash is not changed after the end of the string. */
+#define EOS_HASH_STEP_(s_, i_, h_)                                             \
+    ((eos_u32_t)(h_) * (((i_) < sizeof(s_) - 1) ? 33U : 1U) +                  \
+     (((i_) < sizeof(s_) - 1) ?                                                \
+        (eos_u32_t)(s_)[((i_) < sizeof(s_)) ? (i_) : 0] : 0U))
+
 void eos_event_send(const char *task, const char *topic);
+void eos_event_send_id(eos_u32_t task_id, const char *topic);
+void eos_event_send_h(eos_u32_t task_id, eos_topic_t topic);
 void eos_event_send_delay(const char *task,
                             const char *topic,
                             eos_u32_t time_delay_ms);
@@ -273,16 +443,99 @@ void eos_event_send_period(const char *task,
                             eos_u32_t time_period_ms);
 
 void eos_event_publish(const char *topic);
+void eos_event_publish_h(eos_topic_t topic);
+
+/*
+ * The small value is carried inside the event, and got from e->value in the
+ * same waiting, without any database access. Only for topic-type events.
+ */
+void eos_event_send_u32(const char *task, const char *topic, eos_u32_t value);
+void eos_event_send_u32_h(eos_u32_t task_id,
+                            eos_topic_t topic, eos_u32_t value);
+void eos_event_publish_u32(const char *topic, eos_u32_t value);
+void eos_event_publish_u32_h(eos_topic_t topic, eos_u32_t value);
+
+#if (EOS_SIZE_ISR_RING != 0)
+/*
+ * The event published in ISR is only recorded in a ring, and published by the
+ * ISR task of EOS_ISR_TASK_PRIO later, so the interrupt is disabled for a short
+ * and constant time. It returns false and counts it if the ring is full.
+ */
+typedef struct eos_event_isr_info
+{
+    eos_u16_t capacity;
+    eos_u16_t used_max;                     // The high-water mark.
+    eos_u32_t overflow;                     // The count of dropped events.
+} eos_event_isr_info_t;
+
+bool eos_event_publish_from_isr(eos_topic_t topic, eos_u32_t value);
+void eos_event_isr_info(eos_event_isr_info_t * const info);
+#endif
+
+#if (EOS_USE_EVENT_DATA != 0)
+/*
+ * The payload buffer is allocated from the kernel pool, and owned by the kernel
+ * after publishing. The subscribers read it by e->data without any copy, until
+ * they wait for the next event. It is freed when the last subscriber releases
+ * it. The buffer which is not published should be freed by the user.
+ */
+void *eos_event_buf_alloc(eos_u32_t size);
+void eos_event_buf_free(void *buf);
+void eos_event_publish_buf(const char *topic, void *buf);
+#endif
 void eos_event_publish_delay(const char *topic, eos_u32_t time_delay_ms);
 void eos_event_publish_period(const char *topic, eos_u32_t time_period_ms);
 
+/* Cancelling the one-shot time event after its timeout does nothing. */
 void eos_event_time_cancel(const char *topic);
 
 void eos_event_sub(const char *topic);
+void eos_event_sub_h(eos_topic_t topic);
 void eos_event_unsub(const char *topic);
 
 bool eos_event_topic(eos_event_t const * const e, const char *topic);
 
+/* -----------------------------------------------------------------------------
+Heap
+----------------------------------------------------------------------------- */
+#if (EOS_USE_HEAP_TLSF != 0)
+/* The TLSF heap manages 64KB at most with the default class numbers. */
+#define EOS_HEAP_FL_COUNT               11
+#define EOS_HEAP_SL_LOG2                3
+#define EOS_HEAP_SL_COUNT               (1 << EOS_HEAP_SL_LOG2)
+#endif
+
+typedef struct eos_heap
+{
+    eos_u8_t *data;
+#if (EOS_USE_HEAP_TLSF != 0)
+    eos_u32_t fl_bitmap;
+    eos_u32_t sl_bitmap[EOS_HEAP_FL_COUNT];
+    struct eos_heap_block *blocks[EOS_HEAP_FL_COUNT][EOS_HEAP_SL_COUNT];
+#else
+    struct eos_heap_block *list;
+#endif
+    eos_u32_t size                              : 24;
+    eos_u32_t error_id                          : 8;
+    eos_u32_t size_used;
+    eos_u32_t size_used_max;
+} eos_heap_t;
+
+typedef struct eos_heap_stats
+{
+    eos_u32_t size;
+    eos_u32_t size_free;
+    eos_u32_t size_free_max;                // The largest free block.
+    eos_u32_t size_used_max;                // The high-water mark.
+    eos_u8_t fragment;                      // The fragmentation in percent.
+} eos_heap_stats_t;
+
+/* The heap functions are not protected, the caller should do it. */
+void eos_heap_init(eos_heap_t *const me, void *data, eos_u32_t size);
+void * eos_heap_malloc(eos_heap_t *const me, eos_u32_t size);
+void eos_heap_free(eos_heap_t *const me, void * data);
+void eos_heap_stats(eos_heap_t *const me, eos_heap_stats_t * const stats);
+
 /* -----------------------------------------------------------------------------
 Database
 ----------------------------------------------------------------------------- */
@@ -290,13 +543,178 @@ Database
 #define EOS_DB_ATTRIBUTE_PERSISTENT      ((eos_u8_t)0x20U)
 #define EOS_DB_ATTRIBUTE_VALUE           ((eos_u8_t)0x01U)
 #define EOS_DB_ATTRIBUTE_STREAM          ((eos_u8_t)0x02U)
+/*
+ * The stream is written and read without disabling the interrupt, by the
+ * handle functions eos_db_stream_write_h() and eos_db_stream_read_h(). It has
+ * one producer, such as an interrupt handler, and one consumer. The data not
+ * fitting in the stream is dropped and counted, instead of asserting.
+ *
+ * The value is copied by words under a sequence counter, without disabling
+ * the interrupt. It may be written by many tasks and interrupt handlers, and
+ * the reader copies again if the value is changed meanwhile. It is read in
+ * tasks only. The handle functions do not disable the interrupt at all.
+ */
+#define EOS_DB_ATTRIBUTE_LOCK_FREE       ((eos_u8_t)0x04U)
+/*
+ * The stream is subscribed by many tasks, and every subscriber reads it from
+ * its own cursor, which starts from the newest data when subscribing. The
+ * slowest subscriber decides the free space. With the overwrite policy, the
+ * writing is never refused, the oldest data is overwritten and the subscriber
+ * losing data is flagged, and it knows it by eos_db_stream_lagging(). The
+ * subscribers are woken by publishing the topic of the stream.
+ */
+#define EOS_DB_ATTRIBUTE_BROADCAST       ((eos_u8_t)0x08U)
+#define EOS_DB_ATTRIBUTE_OVERWRITE       ((eos_u8_t)0x10U)
+/*
+ * The value is only written if it is changed, or out of the deadband set by
+ * eos_db_deadband_s32() or eos_db_deadband_f32(), and its value event is only
+ * given if it is written since the last one. The unchanged writes are counted.
+ * It is for the value key, sharing the bit with EOS_DB_ATTRIBUTE_OVERWRITE,
+ * and not for the lock-free value.
+ */
+#define EOS_DB_ATTRIBUTE_ON_CHANGE       ((eos_u8_t)0x10U)
+/*
+ * The value has EOS_DB_VERSIONS versions in its memory, for the large value
+ * read far more often than written. The reader gets the current version in
+ * place, and the writer fills a spare version and makes it current at once.
+ * The old version is reused after all its readers release it. It is for the
+ * value key, sharing the bit with EOS_DB_ATTRIBUTE_BROADCAST, and neither for
+ * the lock-free value nor with EOS_DB_ATTRIBUTE_ON_CHANGE.
+ */
+#define EOS_DB_ATTRIBUTE_BUFFERED        ((eos_u8_t)0x08U)
 
 void eos_db_init(void *const memory, eos_u32_t size);
-void eos_db_register(const char *topic, eos_u32_t size, eos_u8_t attribute);
+/*
+ * It returns EOS_ERROR without registering the key, if the key is persistent
+ * and has the same hash value as another registered persistent key, for the
+ * records in the flash are only found by the hash value. Rename one of them.
+ */
+eos_err_t eos_db_register(const char *topic, eos_u32_t size,
+                          eos_u8_t attribute);
+/*
+ * The memory of the key is freed. The key is also removed from the object
+ * table if no task subscribes it and no event of it is pending, so its topic
+ * handle should not be used.
+ */
+void eos_db_unregister(const char *topic);
 void eos_db_block_read(const char *topic, void * const data);
 void eos_db_block_write(const char *topic, void * const data);
+void eos_db_block_read_h(eos_topic_t topic, void * const data);
+void eos_db_block_write_h(eos_topic_t topic, void * const data);
+/*
+ * Only the bytes from the offset are copied. The value is cut into 32 regions
+ * at most, and the value event has the mask of the regions written since the
+ * last event in e.value, which eos_db_range_mask() gives for one field.
+ */
+void eos_db_write_range(const char *topic,
+                        eos_u32_t offset, eos_u32_t size, const void *data);
+void eos_db_read_range(const char *topic,
+                       eos_u32_t offset, eos_u32_t size, void *data);
+eos_u32_t eos_db_range_mask(const char *topic, eos_u32_t offset, eos_u32_t size);
+/* The value is made of 32-bit numbers, which are changed if out of the band. */
+void eos_db_deadband_s32(const char *topic, eos_u32_t band);
+void eos_db_deadband_f32(const char *topic, float band);
+/* The count of the writes skipped for the unchanged value. */
+eos_u32_t eos_db_suppressed(const char *topic);
+/*
+ * The acquired version of the buffered value is not written until it is
+ * released, so it is read without copying, but it should be released soon, or
+ * the writer may wait for a spare version. The reserved version has an older
+ * value, and is filled wholly before committing. The writers take turns, and
+ * the waiting writer sleeps one tick every time, so it writes in tasks only.
+ * The block and range functions copy the buffered value in the same way.
+ */
+const void *eos_db_value_acquire(const char *topic);
+void eos_db_value_release(const char *topic, const void *data);
+void *eos_db_value_reserve(const char *topic);
+void eos_db_value_commit(const char *topic, void *data);
 eos_s32_t eos_db_stream_read(const char *topic, void *const buffer, eos_u32_t size);
 void eos_db_stream_write(const char *topic, void *const buffer, eos_u32_t size);
+eos_s32_t eos_db_stream_read_h(eos_topic_t topic,
+                               void *const buffer, eos_u32_t size);
+void eos_db_stream_write_h(eos_topic_t topic, void *const buffer, eos_u32_t size);
+/* The count of the writes dropped for the full stream. */
+eos_u32_t eos_db_stream_dropped(const char *topic);
+/* If the current task lost some data of the broadcast stream, and clear it. */
+bool eos_db_stream_lagging(const char *topic);
+
+/*
+ * The stream memory is written and read in place. The span has two regions at
+ * most, the first one ends at the end of the stream memory, and the second one
+ * starts from its beginning. The producer writes into the span got from
+ * eos_db_stream_reserve(), which gives nothing if less than min bytes are
+ * free, and then commits the bytes written. The consumer reads the span got
+ * from eos_db_stream_peek(), and then releases the bytes read. Every stream
+ * has one producer and one consumer for the in-place functions.
+ */
+typedef struct eos_db_span
+{
+    void *data[2];
+    eos_u32_t size[2];
+} eos_db_span_t;
+
+eos_u32_t eos_db_stream_reserve(const char *topic,
+                                eos_u32_t min, eos_db_span_t * const span);
+void eos_db_stream_commit(const char *topic, eos_u32_t size);
+eos_u32_t eos_db_stream_peek(const char *topic, eos_db_span_t * const span);
+void eos_db_stream_release(const char *topic, eos_u32_t size);
+
+/*
+ * The waiting reader is woken when at least level_high bytes are in the
+ * stream, and the waiting writer when at most level_low bytes are left, so
+ * both are woken once for a batch of data. By default, the reader is woken by
+ * any data, and the writer by any space. eos_db_stream_read_wait() reads what
+ * is in the stream at the timeout, maybe nothing. eos_db_stream_write_wait()
+ * writes nothing at the timeout, and returns false. The lock-free stream has
+ * no waiting functions.
+ */
+void eos_db_stream_watermark(const char *topic,
+                             eos_u32_t level_high, eos_u32_t level_low);
+eos_s32_t eos_db_stream_read_wait(const char *topic, void *const buffer,
+                                  eos_u32_t size, eos_s32_t time_ms);
+bool eos_db_stream_write_wait(const char *topic, void *const buffer,
+                              eos_u32_t size, eos_s32_t time_ms);
+
+#if (EOS_USE_DB_PERSIST != 0)
+/*
+ * The value key with EOS_DB_ATTRIBUTE_PERSISTENT is saved in a log in the
+ * flash. The writing only marks the key, and the persist task saves the last
+ * value of every marked key in one batch, EOS_PERSIST_DELAY_MS after the first
+ * writing. Every record has its CRC, and the broken one is skipped for the
+ * older one of the same key. The log goes through all the sectors in turn, and
+ * the live records of the oldest sector are moved before it is erased, so the
+ * sectors are worn evenly. The flash is mounted after eos_init() by scanning
+ * the record headers only, and the persistent key gets its saved value when
+ * mounting, or when registered later. The records are found by the hash value
+ * of the key, so eos_db_register() rejects two persistent keys with the same
+ * hash value. The addresses of the flash functions start from 0, and the
+ * functions return 0 for success.
+ */
+typedef struct eos_flash
+{
+    eos_u32_t sector_size;
+    eos_u16_t sector_count;                 // 3 at least.
+    eos_u16_t align;                        // The programming unit, 4 ~ 64.
+    eos_s32_t (* read)(eos_u32_t addr, void *data, eos_u32_t size);
+    eos_s32_t (* write)(eos_u32_t addr, const void *data, eos_u32_t size);
+    eos_s32_t (* erase)(eos_u32_t addr);    // The sector from the address.
+} eos_flash_t;
+
+typedef struct eos_db_persist_info
+{
+    eos_u32_t records;                      // The records found in mounting.
+    eos_u32_t saves;
+    eos_u32_t bytes_value;                  // The value bytes saved.
+    eos_u32_t bytes_flash;                  // All the bytes programmed.
+    eos_u32_t erases;
+    eos_u32_t collects;                     // The sectors collected.
+} eos_db_persist_info_t;
+
+void eos_db_persist_mount(const eos_flash_t *flash);
+/* Save the marked keys at once, and wait until they are in the flash. */
+void eos_db_persist_flush(void);
+void eos_db_persist_info(eos_db_persist_info_t * const info);
+#endif
 
 /* -----------------------------------------------------------------------------
 Reactor
@@ -366,6 +784,119 @@ eos_ret_t eos_state_top(eos_sm_t * const me, eos_event_t const * const e);
 #define EOS_STATE_CAST(state)       ((eos_state_handler)(state))
 #endif
 
+/* -----------------------------------------------------------------------------
+Static registry
+----------------------------------------------------------------------------- */
+#if (EOS_USE_STATIC_REG != 0)
+/*
+ * The tasks, reactors, state machines, database keys and subscriptions are
+ * declared in the building time, and placed in the section EosReg. eos_init()
+ * only walks the section to register them, first the database keys, then the
+ * tasks, and last the subscriptions. The database key uses its own memory, so
+ * it is registered before eos_db_init(). For GCC, the linker script keeps the
+ * section by KEEP(*(EosReg)), and __start_EosReg and __stop_EosReg are got.
+ */
+enum
+{
+    EosReg_None = 0,
+    EosReg_Db,
+    EosReg_Task,
+    EosReg_Reactor,
+    EosReg_Sm,
+    EosReg_Sub,
+};
+
+typedef void (* eos_reg_func_t)(void);
+
+typedef struct eos_reg
+{
+    const char *name;                       // The task name or database key.
+    const char *topic;                      // The topic subscribed.
+    void *object;                           // The task, or the key memory.
+    eos_reg_func_t func;                    // Entry, handler or initial state.
+    void *parameter;
+    void *stack;
+    eos_u32_t size;                         // The stack size or key size.
+    eos_u8_t kind;
+    eos_u8_t priority;
+    eos_u8_t attribute;
+} eos_reg_t;
+
+/* The memory size of the stream head in the database, and the one of the
+   cursors of the broadcast stream. The buffered value has its other versions
+   in place of the cursors. */
+#define EOS_DB_STREAM_HEAD_SIZE                                                \
+    (32 + 8 * ((EOS_MAX_TASKS + 31) / 32))
+#define EOS_DB_STREAM_READER_SIZE                                              \
+    (4 * (EOS_MAX_TASKS + ((EOS_MAX_TASKS + 31) / 32)))
+
+#if defined(_WIN32) && defined(__GNUC__)
+#define EOS_REG_SECTION                     "EosReg$m"
+#else
+#define EOS_REG_SECTION                     "EosReg"
+#endif
+
+/* GCC may enlarge the alignment of the large objects, so the entries are not
+   placed one by one in the section without the given alignment. */
+#if defined(__GNUC__)
+#define EOS_REG_ALIGN                       __attribute__((aligned(sizeof(void *))))
+#else
+#define EOS_REG_ALIGN
+#endif
+
+#define EOS_REG_(id_)                                                          \
+    EOS_USED EOS_REG_ALIGN const eos_reg_t eos_reg_##id_                       \
+        EOS_SECTION(EOS_REG_SECTION)
+
+#define EOS_TASK_DEFINE(task_, name_, entry_, parameter_,                      \
+                        stack_size_, priority_)                                \
+    eos_task_t task_;                                                          \
+    static eos_u64_t task_##_stack[(stack_size_) / 8];                         \
+    EOS_REG_(task_) =                                                          \
+    {                                                                          \
+        name_, EOS_NULL, &task_, (eos_reg_func_t)(entry_), parameter_,         \
+        task_##_stack, sizeof(task_##_stack), EosReg_Task, priority_, 0        \
+    }
+
+#define EOS_REACTOR_DEFINE(reactor_, name_, priority_, stack_size_, handler_)  \
+    eos_reactor_t reactor_;                                                    \
+    static eos_u64_t reactor_##_stack[(stack_size_) / 8];                      \
+    EOS_REG_(reactor_) =                                                       \
+    {                                                                          \
+        name_, EOS_NULL, &reactor_, (eos_reg_func_t)(handler_), EOS_NULL,      \
+        reactor_##_stack, sizeof(reactor_##_stack),                            \
+        EosReg_Reactor, priority_, 0                                           \
+    }
+
+#define EOS_SM_DEFINE(sm_, name_, priority_, stack_size_, state_init_)         \
+    eos_sm_t sm_;                                                              \
+    static eos_u64_t sm_##_stack[(stack_size_) / 8];                           \
+    EOS_REG_(sm_) =                                                            \
+    {                                                                          \
+        name_, EOS_NULL, &sm_, (eos_reg_func_t)(state_init_), EOS_NULL,        \
+        sm_##_stack, sizeof(sm_##_stack), EosReg_Sm, priority_, 0              \
+    }
+
+#define EOS_DB_DEFINE(id_, key_, size_, attribute_)                            \
+    static eos_u64_t id_##_db[((size_) + EOS_DB_STREAM_HEAD_SIZE +              \
+        ((((attribute_) & EOS_DB_ATTRIBUTE_BROADCAST) == 0) ? 0 :              \
+         (((attribute_) & EOS_DB_ATTRIBUTE_STREAM) != 0) ?                     \
+            EOS_DB_STREAM_READER_SIZE :                                        \
+            ((((size_) + 7) & ~7U) * (EOS_DB_VERSIONS - 1) + 8)) + 7) / 8];    \
+    EOS_REG_(id_) =                                                            \
+    {                                                                          \
+        key_, EOS_NULL, id_##_db, EOS_NULL, EOS_NULL, EOS_NULL,                \
+        size_, EosReg_Db, 0, attribute_                                        \
+    }
+
+#define EOS_SUB_DEFINE(id_, name_, topic_)                                     \
+    EOS_REG_(id_) =                                                            \
+    {                                                                          \
+        name_, topic_, EOS_NULL, EOS_NULL, EOS_NULL, EOS_NULL,                 \
+        0, EosReg_Sub, 0, 0                                                    \
+    }
+#endif
+
 /* -----------------------------------------------------------------------------
 Assert
 ----------------------------------------------------------------------------- */
@@ -417,6 +948,25 @@ void eos_port_assert(const char *tag, const char *name, eos_u32_t id);
 
 #ifdef __cplusplus
 }
+
+/* In C++, the topic hash is calculated by the constexpr function. */
+constexpr eos_u32_t eos_topic_hash_(const char *topic, eos_u32_t hash)
+{
+    return (*topic == 0) ?
+            (hash & 0x7fffffffU) :
+            eos_topic_hash_(topic + 1, hash * 33U + (eos_u32_t)*topic);
+}
+
+template <eos_u32_t hash_>
+struct eos_topic_hash_const_
+{
+    static const eos_u32_t value = hash_;
+};
+
+#define EOS_TOPIC(topic_)                                                      \
+    eos_topic_get_hashed(topic_,                                               \
+        eos_topic_hash_const_<                                                 \
+            eos_topic_hash_("" topic_, EOS_TOPIC_HASH_SEED)>::value)
 #endif
 
 #endif
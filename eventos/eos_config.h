@@ -45,7 +45,7 @@
 
 //   <o>  The maximum number of objects: 16 - 65536
 #define EOS_MAX_OBJECTS                         128
-#define EOS_MAX_HASH_SEEK_TIMES                 5
+#define EOS_MAX_HASH_SEEK_TIMES                 8
 
 //   <o>  The time of system tick.
 #define EOS_TICK_MS                             1
@@ -106,17 +106,63 @@
 //   <o>  use event pub-sub mode (0 or 1) <0-1>
 #define EOS_USE_PUB_SUB                         1
 
+//   <o>  use the topic table generated by tools/eos_topic_gen.py (0 or 1) <0-1>
+//   It may be given by the compiler, as test/eos/x_build_topic.bat does.
+#ifndef EOS_USE_TOPIC_TABLE
+#define EOS_USE_TOPIC_TABLE                     0
+#endif
+
+//   <o>  use the static registry of tasks, keys and subscriptions (0 or 1) <0-1>
+#define EOS_USE_STATIC_REG                      0
+
 
 /* Time Event Configuration ------------------------------------------------- */
 //   <o>  use time event (0 or 1) <0-1>
 #define EOS_USE_TIME_EVENT                      1
 
+//   <o>  The maximum number of time events running at the same time <1-65535>
+#define EOS_MAX_TIMERS                          32
+
 /* Event's Data Configuration ----------------------------------------------- */
-//   <o>  use time event (0 or 1) <0-1>
+//   <o>  use event payload buffer (0 or 1) <0-1>
 #define EOS_USE_EVENT_DATA                      1
 
-//   <o>  The maximum size of event heap (128 - 32767) <128-32767>
-#define EOS_SIZE_HEAP                           5120
+//   <o>  The size of the event payload buffer pool (256 - 65535) <256-65535>
+#define EOS_SIZE_EVENT_BUF                      4096
+
+//   <o>  use the TLSF heap for the database, or the first-fit one (0 or 1) <0-1>
+#define EOS_USE_HEAP_TLSF                       1
+
+//   <o>  The versions of every buffered value key (2 or 3) <2-3>
+#define EOS_DB_VERSIONS                         3
+
+//   <o>  The maximum number of event records in the pool <1-65535>
+#define EOS_MAX_EVENT_RECORD                    64
+
+//   <o>  The maximum number of pending events of every task, the later ones are dropped (power of 2) <4-256>
+#define EOS_SIZE_MAILBOX                        32
+
+//   <o>  The size of the ring of the events published in ISR, 0 to disable (power of 2) <0-256>
+#define EOS_SIZE_ISR_RING                       32
+
+//   <o>  The priority of the task publishing the events recorded in ISR
+#define EOS_ISR_TASK_PRIO                       0
+
+/* Persistent Key Configuration --------------------------------------------- */
+//   <o>  use the flash log for the keys with EOS_DB_ATTRIBUTE_PERSISTENT (0 or 1) <0-1>
+#define EOS_USE_DB_PERSIST                      0
+
+//   <o>  The maximum number of the keys saved in the flash <1-1024>
+#define EOS_MAX_PERSIST_KEYS                    32
+
+//   <o>  The maximum size of one persistent value <4-4096>
+#define EOS_SIZE_PERSIST_VALUE                  256
+
+//   <o>  The delay of saving the written keys in one batch (ms)
+#define EOS_PERSIST_DELAY_MS                    100
+
+//   <o>  The priority of the task saving the persistent keys
+#define EOS_PERSIST_TASK_PRIO                   (EOS_MAX_PRIORITY - 2)
 
 /* Error -------------------------------------------------------------------- */
 #if (EOS_MAX_PRIORITY > 32 || EOS_MAX_PRIORITY <= 0)
@@ -144,9 +190,41 @@
 #endif
 
 #if (EOS_USE_EVENT_DATA != 0)
-    #if (EOS_USE_HEAP != 0 && (EOS_SIZE_HEAP < 128 || EOS_SIZE_HEAP > EOS_HEAP_MAX))
-        #error The heap size must be 128 ~ 32767 (32KB) if the function is enabled !
+    #if (EOS_SIZE_EVENT_BUF < 256 || EOS_SIZE_EVENT_BUF > 65535)
+        #error The size of the event payload buffer pool must be 256 ~ 65535 !
     #endif
 #endif
 
+#if ((EOS_SIZE_ISR_RING & (EOS_SIZE_ISR_RING - 1)) != 0 || EOS_SIZE_ISR_RING > 256)
+    #error The size of the ISR event ring must be 0 or a power of 2, and 256 at most !
+#endif
+
+#if (EOS_SIZE_ISR_RING != 0 && EOS_USE_3RD_KERNEL != 0)
+    #error The ISR event ring needs the kernel of EventOS !
+#endif
+
+#if (EOS_USE_DB_PERSIST != 0)
+    #if (EOS_MAX_PERSIST_KEYS < 1 || EOS_MAX_PERSIST_KEYS > 1024)
+        #error The number of persistent keys must be 1 ~ 1024 !
+    #endif
+    #if (EOS_SIZE_PERSIST_VALUE < 4 || EOS_SIZE_PERSIST_VALUE > 4096)
+        #error The size of one persistent value must be 4 ~ 4096 !
+    #endif
+    #if (EOS_USE_3RD_KERNEL != 0)
+        #error The persistent keys need the kernel of EventOS !
+    #endif
+#endif
+
+#if (EOS_DB_VERSIONS < 2 || EOS_DB_VERSIONS > 3)
+    #error The versions of the buffered value key must be 2 ~ 3 !
+#endif
+
+#if (EOS_MAX_EVENT_RECORD < 1 || EOS_MAX_EVENT_RECORD > 65535)
+    #error The number of event records must be 1 ~ 65535 !
+#endif
+
+#if ((EOS_SIZE_MAILBOX & (EOS_SIZE_MAILBOX - 1)) != 0 || EOS_SIZE_MAILBOX > 256)
+    #error The size of the task mailbox must be a power of 2, and 256 at most !
+#endif
+
 #endif
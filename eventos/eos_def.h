@@ -78,13 +78,20 @@ typedef bool                            eos_bool_t;
     #define EOS_USED                    __attribute__((used))
     #define ALIGN(n)                    __attribute__((aligned(n)))
     #define eos_inline                  static __inline
+    #if (__ARMCC_VERSION >= 6000000)
+    #define EOS_MEMORY_BARRIER()        __builtin_arm_dmb(0xF)
+    #else
+    #define EOS_MEMORY_BARRIER()        __dmb(0xF)
+    #endif
 #elif defined (__IAR_SYSTEMS_ICC__)     /* for IAR Compiler */
     #include <stdarg.h>
+    #include <intrinsics.h>
     #define EOS_SECTION(x)              @ x
     #define EOS_USED                    __root
     #define PRAGMA(x)                   _Pragma(#x)
     #define ALIGN(n)                    PRAGMA(data_alignment=n)
     #define eos_inline                   static inline
+    #define EOS_MEMORY_BARRIER()        __DMB()
 #elif defined (__GNUC__)                /* GNU GCC Compiler */
     /* the version of GNU GCC must be greater than 4.x */
     typedef __builtin_va_list           __gnuc_va_list;
@@ -96,9 +103,11 @@ typedef bool                            eos_bool_t;
     #define EOS_USED                    __attribute__((used))
     #define ALIGN(n)                    __attribute__((aligned(n)))
     #define eos_inline                  static __inline
+    #define EOS_MEMORY_BARRIER()        __sync_synchronize()
 #else
     #define eos_inline                  static inline
     #define ALIGN(n)                    __attribute__((aligned(n)))
+    #define EOS_MEMORY_BARRIER()
 #endif
 
 /*
@@ -4,5 +4,23 @@
 #include <stdint.h>
 
 void timer_init(uint32_t time_ms);
+uint32_t bsp_time_us(void);
+
+/* The NOR flash simulated in a file, for the persistent keys on the host. */
+typedef struct flash_stats
+{
+    uint32_t bytes_read;
+    uint32_t bytes_write;
+    uint32_t erase_min;                     // The erases of the sectors.
+    uint32_t erase_max;
+    uint32_t error;                         // The bits programmed from 0 to 1.
+} flash_stats_t;
+
+struct eos_flash;
+
+const struct eos_flash *flash_sim_open(const char *path,
+                                       uint32_t sector_size,
+                                       uint16_t sector_count);
+void flash_sim_stats(flash_stats_t * const stats);
 
 #endif
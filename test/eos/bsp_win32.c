@@ -1,6 +1,18 @@
 #include "bsp.h"
+#include <windows.h>
 
 void timer_init(uint32_t time_ms)
 {
     (void)time_ms;
 }
+
+/* The time in microseconds from the performance counter, only for measuring
+   the short durations, such as the booting of EventOS. */
+uint32_t bsp_time_us(void)
+{
+    LARGE_INTEGER frequency, count;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&count);
+
+    return (uint32_t)((count.QuadPart * 1000000) / frequency.QuadPart);
+}
@@ -0,0 +1,147 @@
+#include "bsp.h"
+#include "eos.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if (EOS_USE_DB_PERSIST != 0)
+
+/* private data ------------------------------------------------------------- */
+static FILE *flash_file = NULL;
+static uint32_t *flash_erases = NULL;               // The erases of every sector.
+static flash_stats_t flash_stats;
+static eos_flash_t flash_sim;
+
+/* private function --------------------------------------------------------- */
+static eos_s32_t flash_read(eos_u32_t addr, void *data, eos_u32_t size)
+{
+    if ((addr + size) > (flash_sim.sector_size * flash_sim.sector_count))
+    {
+        return -1;
+    }
+
+    fseek(flash_file, (long)addr, SEEK_SET);
+    if (fread(data, 1, size, flash_file) != size)
+    {
+        return -1;
+    }
+    flash_stats.bytes_read += size;
+
+    return 0;
+}
+
+/* The flash is NOR flash. The bits are only programmed from 1 to 0, and the
+   bits programmed from 0 to 1 are counted as the errors. */
+static eos_s32_t flash_write(eos_u32_t addr, const void *data, eos_u32_t size)
+{
+    uint8_t buffer[256];
+    const uint8_t *bytes = (const uint8_t *)data;
+
+    if ((addr + size) > (flash_sim.sector_size * flash_sim.sector_count) ||
+        ((addr | size) & (flash_sim.align - 1)) != 0)
+    {
+        return -1;
+    }
+
+    for (uint32_t offset = 0; offset < size; offset += sizeof(buffer))
+    {
+        uint32_t len = size - offset;
+        len = (len > sizeof(buffer)) ? sizeof(buffer) : len;
+
+        fseek(flash_file, (long)(addr + offset), SEEK_SET);
+        if (fread(buffer, 1, len, flash_file) != len)
+        {
+            return -1;
+        }
+        for (uint32_t i = 0; i < len; i ++)
+        {
+            if ((bytes[offset + i] & ~buffer[i]) != 0)
+            {
+                flash_stats.error ++;
+            }
+            buffer[i] &= bytes[offset + i];
+        }
+        fseek(flash_file, (long)(addr + offset), SEEK_SET);
+        fwrite(buffer, 1, len, flash_file);
+    }
+    fflush(flash_file);
+    flash_stats.bytes_write += size;
+
+    return 0;
+}
+
+static eos_s32_t flash_erase(eos_u32_t addr)
+{
+    uint8_t buffer[256];
+    uint32_t sector = addr / flash_sim.sector_size;
+
+    if (sector >= flash_sim.sector_count)
+    {
+        return -1;
+    }
+
+    memset(buffer, 0xFF, sizeof(buffer));
+    fseek(flash_file, (long)(sector * flash_sim.sector_size), SEEK_SET);
+    for (uint32_t i = 0; i < flash_sim.sector_size; i += sizeof(buffer))
+    {
+        fwrite(buffer, 1, sizeof(buffer), flash_file);
+    }
+    fflush(flash_file);
+    flash_erases[sector] ++;
+
+    return 0;
+}
+
+/* public function ---------------------------------------------------------- */
+/* The file keeps the data between the runs, so the mounting of the saved keys
+   is measured from the second run. */
+const eos_flash_t *flash_sim_open(const char *path,
+                                  uint32_t sector_size, uint16_t sector_count)
+{
+    flash_sim.sector_size = sector_size;
+    flash_sim.sector_count = sector_count;
+    flash_sim.align = 8;
+    flash_sim.read = flash_read;
+    flash_sim.write = flash_write;
+    flash_sim.erase = flash_erase;
+
+    flash_erases = (uint32_t *)calloc(sector_count, sizeof(uint32_t));
+    memset(&flash_stats, 0, sizeof(flash_stats));
+
+    flash_file = fopen(path, "r+b");
+    if (flash_file == NULL)
+    {
+        flash_file = fopen(path, "w+b");
+        if (flash_file == NULL)
+        {
+            return NULL;
+        }
+        for (uint16_t i = 0; i < sector_count; i ++)
+        {
+            flash_erase(i * sector_size);
+            flash_erases[i] = 0;
+        }
+    }
+
+    return &flash_sim;
+}
+
+void flash_sim_stats(flash_stats_t * const stats)
+{
+    *stats = flash_stats;
+    stats->erase_min = 0xFFFFFFFF;
+    stats->erase_max = 0;
+    for (uint16_t i = 0; i < flash_sim.sector_count; i ++)
+    {
+        if (flash_erases[i] < stats->erase_min)
+        {
+            stats->erase_min = flash_erases[i];
+        }
+        if (flash_erases[i] > stats->erase_max)
+        {
+            stats->erase_max = flash_erases[i];
+        }
+    }
+}
+
+#endif
@@ -2,10 +2,14 @@
 #include "eos.h"
 #include <string.h>
 #include <stdint.h>
+#include <stdio.h>
 #include "test.h"
+#include "bsp.h"
 
 int main(void)
 {
+    uint32_t time_boot = bsp_time_us();
+
     // Start EventOS.
     eos_init();                                     // EventOS初始化
 
@@ -15,6 +19,9 @@ int main(void)
 
     test_init();
 
+    // The time of booting, including the static registries in eos_init().
+    printf("EventOS boot time: %u us.\n", (unsigned int)(bsp_time_us() - time_boot));
+
     eos_kernel_start();                                      // EventOS启动
 
     return 0;
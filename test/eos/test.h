@@ -4,22 +4,47 @@
 #include "eos_config.h"
 
 #define TEST_TIME_MAX                   10000
+/* The mode 1 is given by x_build_topic.bat, for the topic table. */
+#ifndef TEST_MODE
 #define TEST_MODE                       0
+#endif
 
 #if (TEST_MODE == 0)
 
 #define TEST_EN_01_0                    0
 #define TEST_EN_01_1                    0
+#define TEST_EN_01_2                    0
+#define TEST_EN_01_3                    0
 #define TEST_EN_02_0                    0
 #define TEST_EN_02_1                    0
 #define TEST_EN_02_2                    0
+#define TEST_EN_02_3                    0
+#define TEST_EN_02_4                    0
 #define TEST_EN_03                      0
 #define TEST_EN_04                      0
 #define TEST_EN_05_0                    0
 #define TEST_EN_05_1                    0
+#define TEST_EN_05_2                    0
 #define TEST_EN_06                      1
+#define TEST_EN_06_1                    0
 #define TEST_EN_07                      0
+#define TEST_EN_08                      0
 #define TEST_EN_09                      0
+#define TEST_EN_10                      0
+#define TEST_EN_11                      0
+#define TEST_EN_12                      0
+#define TEST_EN_13                      0
+#define TEST_EN_14                      0
+#define TEST_EN_15                      0
+#define TEST_EN_16                      0
+#define TEST_EN_17                      0
+#define TEST_EN_18                      0
+#define TEST_EN_19                      0
+
+/* The pub-sub test, with its keys in eos_topic.txt known in building time. */
+#elif (TEST_MODE == 1)
+
+#define TEST_EN_02_0                    1
 
 #endif
 
@@ -41,9 +41,6 @@ static void task_func_e_value(void *parameter);
 static void task_func_high(void *parameter);
 static void task_func_middle(void *parameter);
 
-extern void eos_event_send_id(uint32_t task_id, const char *topic);
-extern uint32_t eos_get_task_id(const char *task);
-
 /* private data ------------------------------------------------------------- */
 static uint64_t stack_e_give1[64];
 static eos_task_t task_e_give1;
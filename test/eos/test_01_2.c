@@ -0,0 +1,262 @@
+#include "test.h"
+#include <stdint.h>
+#include <stdio.h>
+#include "eos.h"
+#include "bsp.h"
+
+#if (TEST_EN_01_2 != 0)
+
+/* private data structure --------------------------------------------------- */
+typedef struct eos_test
+{
+    uint32_t error;
+    uint8_t isr_func_enable;
+    
+    uint32_t time;
+    uint32_t send_speed;
+    uint32_t recv_speed;
+
+    uint32_t send_count;
+    uint32_t high_count;
+    uint32_t e_one;
+    uint32_t e_backlog;
+    uint32_t backlog;
+    uint32_t backlog_max;
+    uint32_t backlog_round;
+    uint32_t dropped;                       // Dropped for the full mailbox.
+    
+    uint32_t send_give1_count;
+    uint32_t send_give2_count;
+    uint32_t send_isr;
+    
+    uint32_t idle_count;
+} eos_test_t;
+
+typedef struct task_test
+{
+    eos_task_t *task;
+    const char *name;
+    uint8_t prio;
+    void *stack;
+    uint32_t stack_size;
+    void (* func)(void *parameter);
+} task_test_info_t;
+
+static void task_func_e_give1(void *parameter);
+static void task_func_e_give2(void *parameter);
+static void task_func_e_value(void *parameter);
+static void task_func_high(void *parameter);
+static void task_func_backlog(void *parameter);
+
+/* private data ------------------------------------------------------------- */
+static uint64_t stack_e_give1[64];
+static eos_task_t task_e_give1;
+static uint64_t stack_e_give2[64];
+static eos_task_t task_e_give2;
+static uint64_t stack_e_value[64];
+static eos_task_t task_e_value;
+static uint64_t stack_high[64];
+static eos_task_t task_high;
+static uint64_t stack_backlog[64];
+static eos_task_t task_backlog;
+
+eos_test_t eos_test;
+
+static const task_test_info_t task_test_info[] =
+{
+    {
+        &task_e_give1, "TaskGive1", TaskPrio_Give1,
+        stack_e_give1, sizeof(stack_e_give1),
+        task_func_e_give1
+    },
+    {
+        &task_e_give2, "TaskGive2", TaskPrio_Give2,
+        stack_e_give2, sizeof(stack_e_give2),
+        task_func_e_give2
+    },
+    {
+        &task_e_value, "TaskValue", TaskPrio_Value,
+        stack_e_value, sizeof(stack_e_value),
+        task_func_e_value
+    },
+    {
+        &task_high, "TaskHigh", TaskPrio_High,
+        stack_high, sizeof(stack_high),
+        task_func_high
+    },
+    {
+        &task_backlog, "TaskBacklog", TaskPrio_Middle,
+        stack_backlog, sizeof(stack_backlog),
+        task_func_backlog
+    },
+};
+
+/* public function ---------------------------------------------------------- */
+void test_init(void)
+{
+    for (uint32_t i = 0;
+         i < (sizeof(task_test_info) / sizeof(task_test_info_t));
+         i ++)
+    {
+        eos_task_init(task_test_info[i].task,
+                       task_test_info[i].name,
+                       task_test_info[i].func,
+                       EOS_NULL,
+                       task_test_info[i].stack,
+                       task_test_info[i].stack_size,
+                       task_test_info[i].prio);
+        eos_task_startup(task_test_info[i].task);
+    }
+
+    timer_init(1);
+}
+
+void eos_sm_count(void)
+{
+
+}
+
+void eos_reactor_count(void)
+{
+
+}
+
+void eos_idle_count(void)
+{
+    eos_test.idle_count ++;
+}
+
+void timer_isr_1ms(void)
+{
+    eos_interrupt_enter();
+    
+    if (eos_test.isr_func_enable != 0)
+    {
+        eos_event_send("TaskValue", "Event_One");
+        eos_event_send("TaskBacklog", "Event_Backlog");
+        eos_test.send_count ++;
+        eos_test.send_isr ++;
+        eos_test.backlog ++;
+    }
+    
+    eos_interrupt_leave();
+}
+
+/* public function ---------------------------------------------------------- */
+static void task_func_e_give1(void *parameter)
+{
+    (void)parameter;
+    
+    while (1)
+    {
+        eos_test.time = eos_tick_get_ms();
+        eos_test.send_count ++;
+        eos_test.send_give1_count ++;
+        if (eos_test.time != 0)
+        {
+            eos_test.send_speed = eos_test.send_count / eos_test.time;
+        }
+        
+        eos_event_send("TaskValue", "Event_One");
+    }
+}
+
+static void task_func_e_give2(void *parameter)
+{
+    (void)parameter;
+    
+    while (1)
+    {
+        eos_test.time = eos_tick_get_ms();
+        eos_test.send_count ++;
+        eos_test.send_give2_count ++;
+        if (eos_test.time != 0)
+        {
+            eos_test.send_speed = eos_test.send_count / eos_test.time;
+        }
+        
+        eos_event_send("TaskValue", "Event_One");
+    }
+}
+
+static void task_func_e_value(void *parameter)
+{
+    (void)parameter;
+    
+    while (1)
+    {
+        eos_event_t e;
+        if (eos_task_wait_event(&e, EOS_WAIT_FOREVER) == false)
+        {
+            eos_test.error = 1;
+            continue;
+        }
+
+        if (eos_event_topic(&e, "Event_One"))
+        {
+            eos_test.e_one ++;
+            if (eos_test.time != 0)
+            {
+                /* It should be the same as the one in test 01-0, no matter how
+                   many events are pending in the backlog task. */
+                eos_test.recv_speed = eos_test.e_one / eos_test.time;
+            }
+        }
+    }
+}
+
+static void task_func_high(void *parameter)
+{
+    (void)parameter;
+    
+    while (1)
+    {
+        eos_test.send_count ++;
+        eos_test.high_count ++;
+        eos_event_send("TaskValue", "Event_One");
+        eos_event_send("TaskBacklog", "Event_Backlog");
+        eos_test.backlog ++;
+        eos_task_delay_ms(1);
+    }
+}
+
+static void task_func_backlog(void *parameter)
+{
+    (void)parameter;
+    
+    while (1)
+    {
+        /* The events keep pending in the mailbox during the delay. The long
+           delay fills the mailbox, and the later events are dropped. */
+        eos_test.backlog_round ++;
+        if ((eos_test.backlog_round % 16) == 0)
+        {
+            eos_task_delay_ms(EOS_SIZE_MAILBOX * 4);
+        }
+        else
+        {
+            eos_task_delay_ms(10);
+        }
+        if (eos_test.backlog > eos_test.backlog_max)
+        {
+            eos_test.backlog_max = eos_test.backlog;
+        }
+
+        eos_event_t e;
+        while (eos_task_wait_event(&e, 0) == true)
+        {
+            if (eos_event_topic(&e, "Event_Backlog"))
+            {
+                eos_test.e_backlog ++;
+                eos_test.backlog --;
+            }
+        }
+
+        /* The kernel keeps running, and the dropped events are counted. */
+        eos_event_pool_info_t info;
+        eos_event_pool_info(&info);
+        eos_test.dropped = info.mailbox_full;
+    }
+}
+
+#endif
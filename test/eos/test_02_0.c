@@ -110,6 +110,18 @@ void test_init(void)
     }
 
     timer_init(1);
+
+#if (EOS_USE_TOPIC_TABLE != 0)
+    /* The keys in eos_topic.txt take the first objects, and are found there. */
+    eos_hash_info_t info;
+    eos_hash_info(&info);
+    if (info.count_known == 0 ||
+        eos_topic_get("Event_One") >= info.count_known ||
+        EOS_TOPIC("Event_One") != eos_topic_get("Event_One"))
+    {
+        eos_test.error = 1;
+    }
+#endif
 }
 
 void eos_sm_count(void)
@@ -5,6 +5,11 @@
 
 #if (TEST_EN_03 != 0)
 
+/* private define ----------------------------------------------------------- */
+#define BENCH_STREAM_SIZE                       1024
+#define BENCH_BLOCK_SIZE                        256
+#define ISR_STREAM_SIZE                         64
+
 /* private data structure --------------------------------------------------- */
 typedef struct e_value
 {
@@ -34,6 +39,12 @@ typedef struct eos_test
     
     uint32_t isr_count;
     uint32_t idle_count;
+
+    uint64_t bench_bytes;
+    uint32_t bench_speed;                       // Bytes per second
+
+    uint32_t isr_bytes;                         // The lock-free stream
+    uint32_t isr_dropped;
 } eos_test_t;
 
 typedef struct task_test
@@ -51,6 +62,7 @@ static void task_func_e_give2(void *parameter);
 static void task_func_e_value(void *parameter);
 static void task_func_high(void *parameter);
 static void task_func_middle(void *parameter);
+static void task_func_bench(void *parameter);
 
 /* private data ------------------------------------------------------------- */
 static uint64_t stack_e_give1[64];
@@ -63,11 +75,17 @@ static uint64_t stack_high[64];
 static eos_task_t task_high;
 static uint64_t stack_middle[64];
 static eos_task_t task_middle;
+static uint64_t stack_bench[64];
+static eos_task_t task_bench;
 
 eos_test_t eos_test;
 
 eos_task_t *p_high = EOS_NULL;
 
+static eos_topic_t topic_isr;
+static uint8_t isr_seq_write = 0;
+static uint8_t isr_seq_read = 0;
+
 static const task_test_info_t task_test_info[] =
 {
     {
@@ -95,12 +113,21 @@ static const task_test_info_t task_test_info[] =
         stack_middle, sizeof(stack_middle),
         task_func_middle
     },
+    {
+        &task_bench, "TaskBench", TaskPrio_Give1,
+        stack_bench, sizeof(stack_bench),
+        task_func_bench
+    },
 };
 
 /* public function ---------------------------------------------------------- */
 void test_init(void)
 {
     eos_db_register("Event_One", 5000, EOS_DB_ATTRIBUTE_STREAM);
+    eos_db_register("Event_Bench", BENCH_STREAM_SIZE, EOS_DB_ATTRIBUTE_STREAM);
+    eos_db_register("Event_Isr", ISR_STREAM_SIZE,
+                    EOS_DB_ATTRIBUTE_STREAM | EOS_DB_ATTRIBUTE_LOCK_FREE);
+    topic_isr = eos_topic_get("Event_Isr");
 
     for (uint32_t i = 0;
          i < (sizeof(task_test_info) / sizeof(task_test_info_t));
@@ -144,6 +171,11 @@ void timer_isr_1ms(void)
         eos_db_stream_write("Event_One", "1", 1);
         eos_event_send("TaskValue", "Event_One");
     }
+
+    /* The lock-free stream is written without disabling the interrupt. The
+       byte is dropped if the stream is full. */
+    eos_db_stream_write_h(topic_isr, &isr_seq_write, 1);
+    isr_seq_write ++;
     
     eos_interrupt_leave();
 }
@@ -226,6 +258,21 @@ static void task_func_high(void *parameter)
         eos_db_stream_write("Event_One", "1", 1);
         eos_event_send("TaskValue", "Event_One");
 
+        /* Drain the lock-free stream. The sequence only breaks when some
+           bytes are dropped. */
+        uint8_t buffer[ISR_STREAM_SIZE];
+        int32_t ret = eos_db_stream_read_h(topic_isr, buffer, ISR_STREAM_SIZE);
+        eos_test.isr_dropped = eos_db_stream_dropped("Event_Isr");
+        for (int32_t i = 0; i < ret; i ++)
+        {
+            if (buffer[i] != isr_seq_read && eos_test.isr_dropped == 0)
+            {
+                eos_test.error ++;
+            }
+            isr_seq_read = buffer[i] + 1;
+        }
+        eos_test.isr_bytes += (uint32_t)ret;
+
         eos_task_delay_ms(1);
     }
 }
@@ -246,4 +293,39 @@ static void task_func_middle(void *parameter)
     }
 }
 
+/* The throughput of the stream in bytes per second. The blocks are written
+   and read back through one stream, crossing its end in most times. */
+static void task_func_bench(void *parameter)
+{
+    uint8_t block[BENCH_BLOCK_SIZE];
+    uint8_t seq_write = 0;
+    uint8_t seq_read = 0;
+    (void)parameter;
+
+    while (1)
+    {
+        for (uint32_t i = 0; i < BENCH_BLOCK_SIZE; i ++)
+        {
+            block[i] = seq_write ++;
+        }
+        eos_db_stream_write("Event_Bench", block, BENCH_BLOCK_SIZE);
+
+        int32_t ret = eos_db_stream_read("Event_Bench", block, BENCH_BLOCK_SIZE);
+        for (int32_t i = 0; i < ret; i ++)
+        {
+            if (block[i] != seq_read ++)
+            {
+                eos_test.error ++;
+            }
+        }
+
+        eos_test.bench_bytes += (uint32_t)ret;
+        uint32_t time = eos_tick_get_ms();
+        if (time != 0)
+        {
+            eos_test.bench_speed = (uint32_t)(eos_test.bench_bytes * 1000 / time);
+        }
+    }
+}
+
 #endif
@@ -0,0 +1,155 @@
+#include "test.h"
+#include <stdint.h>
+#include "eos.h"
+#include "bsp.h"
+
+#if (TEST_EN_08 != 0)
+
+/* private define ----------------------------------------------------------- */
+#define HEAP_TEST_SIZE                          8192
+#define HEAP_TEST_BLOCKS                        64
+#define HEAP_TEST_SIZE_MAX                      256
+
+/* private data structure --------------------------------------------------- */
+typedef struct eos_test
+{
+    uint32_t error;
+
+    uint32_t time;
+    uint32_t op_speed;
+    uint32_t op_count;
+    uint32_t malloc_failed;
+
+    eos_heap_stats_t stats;
+
+    uint32_t e_sm;
+    uint32_t e_reactor;
+    uint32_t idle_count;
+} eos_test_t;
+
+typedef struct task_test
+{
+    eos_task_t *task;
+    const char *name;
+    uint8_t prio;
+    void *stack;
+    uint32_t stack_size;
+    void (* func)(void *parameter);
+} task_test_info_t;
+
+static void task_func_heap(void *parameter);
+
+/* private data ------------------------------------------------------------- */
+static uint64_t stack_heap[64];
+static eos_task_t task_heap;
+
+static eos_heap_t heap;
+static uint64_t heap_memory[HEAP_TEST_SIZE / 8];
+static uint8_t *block[HEAP_TEST_BLOCKS];
+static uint32_t seed = 1;
+
+eos_test_t eos_test;
+
+static const task_test_info_t task_test_info[] =
+{
+    {
+        &task_heap, "TaskHeap", TaskPrio_Give1,
+        stack_heap, sizeof(stack_heap),
+        task_func_heap
+    },
+};
+
+/* public function ---------------------------------------------------------- */
+void test_init(void)
+{
+    eos_heap_init(&heap, heap_memory, sizeof(heap_memory));
+
+    for (uint32_t i = 0;
+         i < (sizeof(task_test_info) / sizeof(task_test_info_t));
+         i ++)
+    {
+        eos_task_init(task_test_info[i].task,
+                       task_test_info[i].name,
+                       task_test_info[i].func,
+                       EOS_NULL,
+                       task_test_info[i].stack,
+                       task_test_info[i].stack_size,
+                       task_test_info[i].prio);
+        eos_task_startup(task_test_info[i].task);
+    }
+}
+
+void eos_sm_count(void)
+{
+    eos_test.e_sm ++;
+}
+
+void eos_reactor_count(void)
+{
+    eos_test.e_reactor ++;
+}
+
+void timer_isr_1ms(void)
+{
+}
+
+void eos_idle_count(void)
+{
+    eos_test.idle_count ++;
+}
+
+/* private function --------------------------------------------------------- */
+static uint32_t test_rand(void)
+{
+    seed = seed * 1103515245 + 12345;
+
+    return (seed >> 16);
+}
+
+/* Malloc and free the blocks with random sizes at full load. Switch the option
+   EOS_USE_HEAP_TLSF to compare the speed and fragmentation of the two heap. */
+static void task_func_heap(void *parameter)
+{
+    (void)parameter;
+
+    while (1)
+    {
+        uint32_t index = test_rand() % HEAP_TEST_BLOCKS;
+        if (block[index] == EOS_NULL)
+        {
+            uint32_t size = 1 + test_rand() % HEAP_TEST_SIZE_MAX;
+            block[index] = eos_heap_malloc(&heap, size);
+            if (block[index] == EOS_NULL)
+            {
+                eos_test.malloc_failed ++;
+            }
+            else
+            {
+                block[index][0] = (uint8_t)index;
+                block[index][size - 1] = (uint8_t)index;
+            }
+        }
+        else
+        {
+            if (block[index][0] != (uint8_t)index)
+            {
+                eos_test.error ++;
+            }
+            eos_heap_free(&heap, block[index]);
+            block[index] = EOS_NULL;
+        }
+
+        eos_test.op_count ++;
+        eos_test.time = eos_tick_get_ms();
+        if (eos_test.time != 0)
+        {
+            eos_test.op_speed = eos_test.op_count / eos_test.time;
+        }
+        if ((eos_test.op_count % 10000) == 0)
+        {
+            eos_heap_stats(&heap, &eos_test.stats);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,172 @@
+#include "test.h"
+#include <stdint.h>
+#include <stdio.h>
+#include "eos.h"
+#include "bsp.h"
+
+#if (TEST_EN_10 != 0)
+
+/* private define ----------------------------------------------------------- */
+#define SOAK_TIMERS                             48
+#define SOAK_EXPIRE_PERIOD                      10000
+
+#if (EOS_MAX_TIMERS < (SOAK_TIMERS + 1))
+#error "The test 10 needs EOS_MAX_TIMERS not less than 49 in eos_config.h."
+#endif
+
+/* private data structure --------------------------------------------------- */
+typedef struct eos_test
+{
+    uint32_t error;
+
+    uint32_t time;
+    uint32_t op_speed;
+    uint32_t op_count;
+    uint32_t lookup_count;
+    uint32_t cancel_expired;                // The cancellings after timeout.
+
+    eos_hash_info_t hash_info;
+    uint16_t probe_max;
+
+    uint32_t e_sm;
+    uint32_t e_reactor;
+    uint32_t idle_count;
+} eos_test_t;
+
+typedef struct task_test
+{
+    eos_task_t *task;
+    const char *name;
+    uint8_t prio;
+    void *stack;
+    uint32_t stack_size;
+    void (* func)(void *parameter);
+} task_test_info_t;
+
+static void task_func_soak(void *parameter);
+
+/* private data ------------------------------------------------------------- */
+static uint64_t stack_soak[64];
+static eos_task_t task_soak;
+
+static char topic_timer[SOAK_TIMERS][16];
+static bool timer_active[SOAK_TIMERS];
+static uint32_t seed = 1;
+
+eos_test_t eos_test;
+
+static const task_test_info_t task_test_info[] =
+{
+    {
+        &task_soak, "TaskSoak", TaskPrio_Give1,
+        stack_soak, sizeof(stack_soak),
+        task_func_soak
+    },
+};
+
+/* public function ---------------------------------------------------------- */
+void test_init(void)
+{
+    for (uint32_t i = 0; i < SOAK_TIMERS; i ++)
+    {
+        sprintf(topic_timer[i], "Soak_%u", (unsigned int)i);
+    }
+    eos_topic_get("Event_Lookup");
+
+    for (uint32_t i = 0;
+         i < (sizeof(task_test_info) / sizeof(task_test_info_t));
+         i ++)
+    {
+        eos_task_init(task_test_info[i].task,
+                       task_test_info[i].name,
+                       task_test_info[i].func,
+                       EOS_NULL,
+                       task_test_info[i].stack,
+                       task_test_info[i].stack_size,
+                       task_test_info[i].prio);
+        eos_task_startup(task_test_info[i].task);
+    }
+}
+
+void eos_sm_count(void)
+{
+    eos_test.e_sm ++;
+}
+
+void eos_reactor_count(void)
+{
+    eos_test.e_reactor ++;
+}
+
+void timer_isr_1ms(void)
+{
+}
+
+void eos_idle_count(void)
+{
+    eos_test.idle_count ++;
+}
+
+/* private function --------------------------------------------------------- */
+static uint32_t test_rand(void)
+{
+    seed = seed * 1103515245 + 12345;
+
+    return (seed >> 16);
+}
+
+/* Start and cancel the time events at full load, and look up one event among
+   them. The object table is reused without end, and the longest seeking is
+   not getting longer. */
+static void task_func_soak(void *parameter)
+{
+    (void)parameter;
+
+    while (1)
+    {
+        uint32_t index = test_rand() % SOAK_TIMERS;
+        if (timer_active[index])
+        {
+            eos_event_time_cancel(topic_timer[index]);
+        }
+        else
+        {
+            eos_event_publish_period(topic_timer[index], 1000);
+        }
+        timer_active[index] = !timer_active[index];
+
+        eos_topic_get("Event_Lookup");
+        eos_test.lookup_count ++;
+
+        /* The one-shot time event is cancelled after its timeout, and started
+           again later. */
+        if ((eos_test.op_count % SOAK_EXPIRE_PERIOD) == 0)
+        {
+            eos_event_publish_delay("Soak_Expire", 1);
+            eos_task_delay_ms(3);
+            eos_event_time_cancel("Soak_Expire");
+            eos_test.cancel_expired ++;
+        }
+
+        eos_test.op_count ++;
+        eos_test.time = eos_tick_get_ms();
+        if (eos_test.time != 0)
+        {
+            eos_test.op_speed = eos_test.op_count / eos_test.time;
+        }
+        if ((eos_test.op_count % 10000) == 0)
+        {
+            eos_hash_info(&eos_test.hash_info);
+            if (eos_test.hash_info.probe_max > eos_test.probe_max)
+            {
+                eos_test.probe_max = eos_test.hash_info.probe_max;
+            }
+            if (eos_test.probe_max > EOS_MAX_HASH_SEEK_TIMES)
+            {
+                eos_test.error ++;
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,97 @@
+#include "test.h"
+#include <stdint.h>
+#include "eos.h"
+#include "bsp.h"
+
+#if (TEST_EN_11 != 0)
+
+#if (EOS_USE_STATIC_REG == 0)
+#error "The test 11 needs EOS_USE_STATIC_REG in eos_config.h."
+#endif
+
+/* private data structure --------------------------------------------------- */
+typedef struct eos_test
+{
+    uint32_t error;
+
+    uint32_t send_count;
+    uint32_t recv_count;
+    uint32_t value;
+
+    uint32_t e_sm;
+    uint32_t e_reactor;
+    uint32_t idle_count;
+} eos_test_t;
+
+static void task_func_static(void *parameter);
+static void reactor_func_static(eos_reactor_t * const me,
+                                eos_event_t const * const e);
+
+/* private data ------------------------------------------------------------- */
+/* All are registered in eos_init(), and test_init() does nothing. */
+EOS_DB_DEFINE(db_static, "Static_Value", sizeof(uint32_t),
+              EOS_DB_ATTRIBUTE_VALUE);
+EOS_TASK_DEFINE(task_static, "TaskStatic", task_func_static, EOS_NULL,
+                512, TaskPrio_Give1);
+EOS_REACTOR_DEFINE(reactor_static, "ReactorStatic", TaskPrio_ReacotrLed,
+                   512, reactor_func_static);
+EOS_SUB_DEFINE(sub_static, "ReactorStatic", "Event_Static");
+
+eos_test_t eos_test;
+
+/* public function ---------------------------------------------------------- */
+void test_init(void)
+{
+}
+
+void eos_sm_count(void)
+{
+    eos_test.e_sm ++;
+}
+
+void eos_reactor_count(void)
+{
+    eos_test.e_reactor ++;
+}
+
+void timer_isr_1ms(void)
+{
+}
+
+void eos_idle_count(void)
+{
+    eos_test.idle_count ++;
+}
+
+/* private function --------------------------------------------------------- */
+static void task_func_static(void *parameter)
+{
+    (void)parameter;
+
+    while (1)
+    {
+        eos_test.send_count ++;
+        eos_db_block_write("Static_Value", &eos_test.send_count);
+        eos_event_publish("Event_Static");
+
+        eos_task_delay_ms(10);
+    }
+}
+
+static void reactor_func_static(eos_reactor_t * const me,
+                                eos_event_t const * const e)
+{
+    (void)me;
+
+    if (eos_event_topic(e, "Event_Static"))
+    {
+        eos_test.recv_count ++;
+        eos_db_block_read("Static_Value", &eos_test.value);
+        if (eos_test.value != eos_test.send_count)
+        {
+            eos_test.error ++;
+        }
+    }
+}
+
+#endif
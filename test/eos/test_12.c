@@ -0,0 +1,196 @@
+#include "test.h"
+#include <stdint.h>
+#include "eos.h"
+#include "bsp.h"
+
+#if (TEST_EN_12 != 0)
+
+/* private define ----------------------------------------------------------- */
+#define DMA_STREAM_SIZE                         500
+#define DMA_BLOCK_MIN                           32
+
+/* private data structure --------------------------------------------------- */
+typedef struct eos_test
+{
+    uint32_t error;
+
+    uint32_t dma_count;
+    uint32_t dma_full;
+    uint32_t dma_bytes;
+    uint32_t recv_count;
+    uint32_t recv_bytes;
+    uint32_t recv_wrapped;                  // The spans in two regions.
+
+    uint32_t e_sm;
+    uint32_t e_reactor;
+    uint32_t idle_count;
+} eos_test_t;
+
+typedef struct task_test
+{
+    eos_task_t *task;
+    const char *name;
+    uint8_t prio;
+    void *stack;
+    uint32_t stack_size;
+    void (* func)(void *parameter);
+} task_test_info_t;
+
+static void task_func_dma(void *parameter);
+static void task_func_recv(void *parameter);
+
+/* private data ------------------------------------------------------------- */
+static uint64_t stack_dma[64];
+static eos_task_t task_dma;
+static uint64_t stack_recv[64];
+static eos_task_t task_recv;
+
+static uint8_t seq_write = 0;
+static uint8_t seq_read = 0;
+static uint32_t seed = 1;
+
+eos_test_t eos_test;
+
+static const task_test_info_t task_test_info[] =
+{
+    {
+        &task_dma, "TaskDma", TaskPrio_High,
+        stack_dma, sizeof(stack_dma),
+        task_func_dma
+    },
+    {
+        &task_recv, "TaskRecv", TaskPrio_Give1,
+        stack_recv, sizeof(stack_recv),
+        task_func_recv
+    },
+};
+
+/* public function ---------------------------------------------------------- */
+void test_init(void)
+{
+    eos_db_register("Event_Dma", DMA_STREAM_SIZE, EOS_DB_ATTRIBUTE_STREAM);
+
+    for (uint32_t i = 0;
+         i < (sizeof(task_test_info) / sizeof(task_test_info_t));
+         i ++)
+    {
+        eos_task_init(task_test_info[i].task,
+                       task_test_info[i].name,
+                       task_test_info[i].func,
+                       EOS_NULL,
+                       task_test_info[i].stack,
+                       task_test_info[i].stack_size,
+                       task_test_info[i].prio);
+        eos_task_startup(task_test_info[i].task);
+    }
+}
+
+void eos_sm_count(void)
+{
+    eos_test.e_sm ++;
+}
+
+void eos_reactor_count(void)
+{
+    eos_test.e_reactor ++;
+}
+
+void timer_isr_1ms(void)
+{
+}
+
+void eos_idle_count(void)
+{
+    eos_test.idle_count ++;
+}
+
+/* private function --------------------------------------------------------- */
+static uint32_t test_rand(void)
+{
+    seed = seed * 1103515245 + 12345;
+
+    return (seed >> 16);
+}
+
+/* Act as a DMA, which fills the stream memory in place every millisecond, and
+   tells the receiver by one event. */
+static void task_func_dma(void *parameter)
+{
+    eos_db_span_t span;
+    (void)parameter;
+
+    while (1)
+    {
+        uint32_t size = eos_db_stream_reserve("Event_Dma", DMA_BLOCK_MIN, &span);
+        if (size == 0)
+        {
+            eos_test.dma_full ++;
+        }
+        else
+        {
+            size = DMA_BLOCK_MIN + test_rand() % (size - DMA_BLOCK_MIN + 1);
+            for (uint32_t i = 0; i < size; i ++)
+            {
+                uint8_t *data = (i < span.size[0]) ?
+                                &((uint8_t *)span.data[0])[i] :
+                                &((uint8_t *)span.data[1])[i - span.size[0]];
+                *data = seq_write ++;
+            }
+            eos_db_stream_commit("Event_Dma", size);
+            eos_test.dma_count ++;
+            eos_test.dma_bytes += size;
+            eos_event_send("TaskRecv", "Event_Dma");
+        }
+
+        eos_task_delay_ms(1);
+    }
+}
+
+/* Check the data in place, and release a part of it in random. */
+static void task_func_recv(void *parameter)
+{
+    eos_event_t e;
+    eos_db_span_t span;
+    (void)parameter;
+
+    while (1)
+    {
+        if (eos_task_wait_event(&e, 10000) == false)
+        {
+            eos_test.error ++;
+            continue;
+        }
+        if (!eos_event_topic(&e, "Event_Dma"))
+        {
+            continue;
+        }
+
+        /* Every event is sent after some bytes are committed. */
+        uint32_t size = eos_db_stream_peek("Event_Dma", &span);
+        if (size == 0)
+        {
+            eos_test.error ++;
+            continue;
+        }
+        if (span.size[1] != 0)
+        {
+            eos_test.recv_wrapped ++;
+        }
+        size = 1 + test_rand() % size;
+        for (uint32_t i = 0; i < size; i ++)
+        {
+            uint8_t data = (i < span.size[0]) ?
+                           ((uint8_t *)span.data[0])[i] :
+                           ((uint8_t *)span.data[1])[i - span.size[0]];
+            if (data != seq_read ++)
+            {
+                eos_test.error ++;
+            }
+        }
+        eos_db_stream_release("Event_Dma", size);
+        eos_test.recv_count ++;
+        eos_test.recv_bytes += size;
+    }
+}
+
+#endif
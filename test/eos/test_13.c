@@ -0,0 +1,206 @@
+#include "test.h"
+#include <stdint.h>
+#include "eos.h"
+#include "bsp.h"
+
+#if (TEST_EN_13 != 0)
+
+/* private define ----------------------------------------------------------- */
+#define BCAST_STREAM_SIZE                       256
+#define BCAST_BLOCK_SIZE                        16
+#define BCAST_READERS                           3
+
+/* private data structure --------------------------------------------------- */
+typedef struct eos_test
+{
+    uint32_t error;
+
+    uint32_t send_count;
+    uint32_t send_bytes;
+    uint32_t recv_bytes[BCAST_READERS];
+    uint32_t lagging[BCAST_READERS];        // The times of losing the data.
+
+    uint32_t e_sm;
+    uint32_t e_reactor;
+    uint32_t idle_count;
+} eos_test_t;
+
+typedef struct task_test
+{
+    eos_task_t *task;
+    const char *name;
+    uint8_t prio;
+    void *stack;
+    uint32_t stack_size;
+    void (* func)(void *parameter);
+} task_test_info_t;
+
+static void task_func_send(void *parameter);
+static void task_func_reader(void *parameter);
+
+/* private data ------------------------------------------------------------- */
+static uint64_t stack_send[64];
+static eos_task_t task_send;
+static uint64_t stack_log[64];
+static eos_task_t task_log;
+static uint64_t stack_decode[64];
+static eos_task_t task_decode;
+static uint64_t stack_record[64];
+static eos_task_t task_record;
+
+static uint8_t seq_write = 0;
+
+eos_test_t eos_test;
+
+/* The reading size and the delay of every reader. The record task is slow, and
+   loses the oldest data sometimes. */
+static const uint32_t reader_size[BCAST_READERS] = { 7, 64, 200 };
+static const uint32_t reader_delay[BCAST_READERS] = { 0, 0, 30 };
+
+static const task_test_info_t task_test_info[] =
+{
+    {
+        &task_send, "TaskSend", TaskPrio_High,
+        stack_send, sizeof(stack_send),
+        task_func_send
+    },
+    {
+        &task_log, "TaskLog", TaskPrio_Value,
+        stack_log, sizeof(stack_log),
+        task_func_reader
+    },
+    {
+        &task_decode, "TaskDecode", TaskPrio_Middle,
+        stack_decode, sizeof(stack_decode),
+        task_func_reader
+    },
+    {
+        &task_record, "TaskRecord", TaskPrio_Give1,
+        stack_record, sizeof(stack_record),
+        task_func_reader
+    },
+};
+
+/* public function ---------------------------------------------------------- */
+void test_init(void)
+{
+    eos_db_register("Event_Bcast", BCAST_STREAM_SIZE,
+                    (EOS_DB_ATTRIBUTE_STREAM |
+                     EOS_DB_ATTRIBUTE_BROADCAST | EOS_DB_ATTRIBUTE_OVERWRITE));
+
+    for (uint32_t i = 0;
+         i < (sizeof(task_test_info) / sizeof(task_test_info_t));
+         i ++)
+    {
+        eos_task_init(task_test_info[i].task,
+                       task_test_info[i].name,
+                       task_test_info[i].func,
+                       (void *)(i - 1),
+                       task_test_info[i].stack,
+                       task_test_info[i].stack_size,
+                       task_test_info[i].prio);
+        eos_task_startup(task_test_info[i].task);
+    }
+}
+
+void eos_sm_count(void)
+{
+    eos_test.e_sm ++;
+}
+
+void eos_reactor_count(void)
+{
+    eos_test.e_reactor ++;
+}
+
+void timer_isr_1ms(void)
+{
+}
+
+void eos_idle_count(void)
+{
+    eos_test.idle_count ++;
+}
+
+/* private function --------------------------------------------------------- */
+/* Write one block into the broadcast stream every millisecond, and wake all the
+   readers by one publishing. */
+static void task_func_send(void *parameter)
+{
+    uint8_t block[BCAST_BLOCK_SIZE];
+    (void)parameter;
+
+    while (1)
+    {
+        for (uint32_t i = 0; i < BCAST_BLOCK_SIZE; i ++)
+        {
+            block[i] = seq_write ++;
+        }
+        eos_db_stream_write("Event_Bcast", block, BCAST_BLOCK_SIZE);
+        eos_event_publish("Event_Bcast");
+        eos_test.send_count ++;
+        eos_test.send_bytes += BCAST_BLOCK_SIZE;
+
+        eos_task_delay_ms(1);
+    }
+}
+
+/* Every reader reads the same data from its own cursor, and checks the order.
+   After losing data, it starts checking again from the next reading. */
+static void task_func_reader(void *parameter)
+{
+    uint32_t index = (uint32_t)parameter;
+    uint8_t buffer[200];
+    uint8_t seq_read = 0;
+    bool synced = false;
+    eos_event_t e;
+
+    eos_event_sub("Event_Bcast");
+
+    while (1)
+    {
+        if (eos_task_wait_event(&e, 10000) == false)
+        {
+            eos_test.error ++;
+            continue;
+        }
+        if (!eos_event_topic(&e, "Event_Bcast"))
+        {
+            continue;
+        }
+        if (reader_delay[index] != 0)
+        {
+            eos_task_delay_ms(reader_delay[index]);
+        }
+
+        eos_s32_t size;
+        while ((size = eos_db_stream_read("Event_Bcast",
+                                          buffer, reader_size[index])) > 0)
+        {
+            eos_test.recv_bytes[index] += size;
+
+            /* The data read may be not continuous after losing data, so it is
+               not checked, and the checking restarts from the next reading. */
+            if (eos_db_stream_lagging("Event_Bcast"))
+            {
+                eos_test.lagging[index] ++;
+                synced = false;
+                continue;
+            }
+            if (synced == false)
+            {
+                seq_read = buffer[0];
+                synced = true;
+            }
+            for (eos_s32_t i = 0; i < size; i ++)
+            {
+                if (buffer[i] != seq_read ++)
+                {
+                    eos_test.error ++;
+                }
+            }
+        }
+    }
+}
+
+#endif
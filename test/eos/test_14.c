@@ -0,0 +1,217 @@
+#include "test.h"
+#include <stdint.h>
+#include "eos.h"
+#include "bsp.h"
+
+#if (TEST_EN_14 != 0)
+
+/* private define ----------------------------------------------------------- */
+#define UART_STREAM_SIZE                        1024
+#define UART_FRAME_SIZE                         512
+#define UART_TIMEOUT_MS                         20
+
+#define LOG_STREAM_SIZE                         256
+#define LOG_BLOCK_SIZE                          48
+#define LOG_LEVEL_LOW                           64
+
+/* private data structure --------------------------------------------------- */
+typedef struct eos_test
+{
+    uint32_t error;
+
+    uint32_t uart_bytes;
+    uint32_t uart_wakeup;                   // The wakeups of the frame reader.
+    uint32_t uart_timeout;                  // The frames shorter than 512.
+    uint32_t log_bytes;
+
+    uint32_t e_sm;
+    uint32_t e_reactor;
+    uint32_t isr_count;
+    uint32_t idle_count;
+} eos_test_t;
+
+typedef struct task_test
+{
+    eos_task_t *task;
+    const char *name;
+    uint8_t prio;
+    void *stack;
+    uint32_t stack_size;
+    void (* func)(void *parameter);
+} task_test_info_t;
+
+static void task_func_frame(void *parameter);
+static void task_func_log_write(void *parameter);
+static void task_func_log_read(void *parameter);
+
+/* private data ------------------------------------------------------------- */
+static uint64_t stack_frame[64];
+static eos_task_t task_frame;
+static uint64_t stack_log_write[64];
+static eos_task_t task_log_write;
+static uint64_t stack_log_read[64];
+static eos_task_t task_log_read;
+
+static uint8_t uart_seq_write = 0;
+static uint8_t uart_seq_read = 0;
+static uint8_t log_seq_write = 0;
+static uint8_t log_seq_read = 0;
+static uint32_t isr_ms = 0;
+
+eos_test_t eos_test;
+
+static const task_test_info_t task_test_info[] =
+{
+    {
+        &task_frame, "TaskFrame", TaskPrio_High,
+        stack_frame, sizeof(stack_frame),
+        task_func_frame
+    },
+    {
+        &task_log_write, "TaskLogWrite", TaskPrio_Value,
+        stack_log_write, sizeof(stack_log_write),
+        task_func_log_write
+    },
+    {
+        &task_log_read, "TaskLogRead", TaskPrio_Middle,
+        stack_log_read, sizeof(stack_log_read),
+        task_func_log_read
+    },
+};
+
+/* public function ---------------------------------------------------------- */
+void test_init(void)
+{
+    /* The frame reader is only woken by a full frame, or by the timeout. */
+    eos_db_register("Event_Uart", UART_STREAM_SIZE, EOS_DB_ATTRIBUTE_STREAM);
+    eos_db_stream_watermark("Event_Uart", UART_FRAME_SIZE, UART_STREAM_SIZE);
+
+    /* The log writer is only woken when the stream is almost empty. */
+    eos_db_register("Event_Log", LOG_STREAM_SIZE, EOS_DB_ATTRIBUTE_STREAM);
+    eos_db_stream_watermark("Event_Log", 1, LOG_LEVEL_LOW);
+
+    for (uint32_t i = 0;
+         i < (sizeof(task_test_info) / sizeof(task_test_info_t));
+         i ++)
+    {
+        eos_task_init(task_test_info[i].task,
+                       task_test_info[i].name,
+                       task_test_info[i].func,
+                       EOS_NULL,
+                       task_test_info[i].stack,
+                       task_test_info[i].stack_size,
+                       task_test_info[i].prio);
+        eos_task_startup(task_test_info[i].task);
+    }
+}
+
+void eos_sm_count(void)
+{
+    eos_test.e_sm ++;
+}
+
+void eos_reactor_count(void)
+{
+    eos_test.e_reactor ++;
+}
+
+/* Act as a UART receiver, a few bytes every millisecond. It pauses for 100ms
+   every second, so the last frame before the pause is cut by the timeout. */
+void timer_isr_1ms(void)
+{
+    uint8_t data[4];
+
+    eos_interrupt_enter();
+
+    isr_ms ++;
+    if ((isr_ms % 1000) < 900)
+    {
+        for (uint32_t i = 0; i < sizeof(data); i ++)
+        {
+            data[i] = uart_seq_write ++;
+        }
+        eos_db_stream_write("Event_Uart", data, sizeof(data));
+        eos_test.isr_count ++;
+    }
+
+    eos_interrupt_leave();
+}
+
+void eos_idle_count(void)
+{
+    eos_test.idle_count ++;
+}
+
+/* private function --------------------------------------------------------- */
+static void task_func_frame(void *parameter)
+{
+    uint8_t frame[UART_FRAME_SIZE];
+    (void)parameter;
+
+    while (1)
+    {
+        eos_s32_t size = eos_db_stream_read_wait("Event_Uart", frame,
+                                                 UART_FRAME_SIZE,
+                                                 UART_TIMEOUT_MS);
+        eos_test.uart_wakeup ++;
+        if (size < UART_FRAME_SIZE)
+        {
+            eos_test.uart_timeout ++;
+        }
+        for (eos_s32_t i = 0; i < size; i ++)
+        {
+            if (frame[i] != uart_seq_read ++)
+            {
+                eos_test.error ++;
+            }
+        }
+        eos_test.uart_bytes += size;
+    }
+}
+
+/* Write the blocks as fast as possible, and wait for the space. */
+static void task_func_log_write(void *parameter)
+{
+    uint8_t block[LOG_BLOCK_SIZE];
+    (void)parameter;
+
+    while (1)
+    {
+        for (uint32_t i = 0; i < LOG_BLOCK_SIZE; i ++)
+        {
+            block[i] = log_seq_write ++;
+        }
+        if (eos_db_stream_write_wait("Event_Log", block,
+                                     LOG_BLOCK_SIZE, 100) == false)
+        {
+            /* The reader never stops for 100ms. */
+            eos_test.error ++;
+            log_seq_write -= LOG_BLOCK_SIZE;
+        }
+    }
+}
+
+/* Read a few bytes every millisecond, slower than the writer. */
+static void task_func_log_read(void *parameter)
+{
+    uint8_t buffer[16];
+    (void)parameter;
+
+    while (1)
+    {
+        eos_s32_t size = eos_db_stream_read("Event_Log",
+                                            buffer, sizeof(buffer));
+        for (eos_s32_t i = 0; i < size; i ++)
+        {
+            if (buffer[i] != log_seq_read ++)
+            {
+                eos_test.error ++;
+            }
+        }
+        eos_test.log_bytes += size;
+
+        eos_task_delay_ms(1);
+    }
+}
+
+#endif
@@ -0,0 +1,209 @@
+#include "test.h"
+#include <stdint.h>
+#include "eos.h"
+#include "bsp.h"
+
+#if (TEST_EN_15 != 0)
+
+/* private define ----------------------------------------------------------- */
+#define VALUE_WORDS                             64          // 256 bytes
+#define VALUE_READ_BURST                        100
+
+/* private data structure --------------------------------------------------- */
+typedef struct e_block
+{
+    uint32_t word[VALUE_WORDS];
+} e_block_t;
+
+typedef struct eos_test
+{
+    uint32_t error;                             // The torn blocks read.
+    uint8_t isr_func_enable;
+
+    uint32_t time;
+    uint32_t send_speed;
+
+    uint32_t send_count;
+    uint32_t read_count;
+    uint32_t e_sm;
+    uint32_t e_reactor;
+
+    uint32_t send_give1_count;
+    uint32_t send_give2_count;
+
+    uint32_t isr_count;
+    uint32_t idle_count;
+} eos_test_t;
+
+typedef struct task_test
+{
+    eos_task_t *task;
+    const char *name;
+    uint8_t prio;
+    void *stack;
+    uint32_t stack_size;
+    void (* func)(void *parameter);
+} task_test_info_t;
+
+static void task_func_e_give1(void *parameter);
+static void task_func_e_give2(void *parameter);
+static void task_func_e_value(void *parameter);
+
+/* private data ------------------------------------------------------------- */
+static uint64_t stack_e_give1[64];
+static eos_task_t task_e_give1;
+static uint64_t stack_e_give2[64];
+static eos_task_t task_e_give2;
+static uint64_t stack_e_value[96];
+static eos_task_t task_e_value;
+
+static eos_topic_t topic_block;
+static e_block_t block_isr;
+
+eos_test_t eos_test;
+
+static const task_test_info_t task_test_info[] =
+{
+    {
+        &task_e_give1, "TaskGive1", TaskPrio_Give1,
+        stack_e_give1, sizeof(stack_e_give1),
+        task_func_e_give1
+    },
+    {
+        &task_e_give2, "TaskGive2", TaskPrio_Give2,
+        stack_e_give2, sizeof(stack_e_give2),
+        task_func_e_give2
+    },
+    {
+        &task_e_value, "TaskValue", TaskPrio_Value,
+        stack_e_value, sizeof(stack_e_value),
+        task_func_e_value
+    },
+};
+
+/* public function ---------------------------------------------------------- */
+void test_init(void)
+{
+    /* The value is copied without disabling the interrupt. */
+    eos_db_register("Event_Block", sizeof(e_block_t),
+                    (EOS_DB_ATTRIBUTE_VALUE | EOS_DB_ATTRIBUTE_LOCK_FREE));
+    topic_block = eos_topic_get("Event_Block");
+
+    for (uint32_t i = 0;
+         i < (sizeof(task_test_info) / sizeof(task_test_info_t));
+         i ++)
+    {
+        eos_task_init(task_test_info[i].task,
+                       task_test_info[i].name,
+                       task_test_info[i].func,
+                       EOS_NULL,
+                       task_test_info[i].stack,
+                       task_test_info[i].stack_size,
+                       task_test_info[i].prio);
+        eos_task_startup(task_test_info[i].task);
+    }
+
+    timer_init(1);
+}
+
+void eos_sm_count(void)
+{
+    eos_test.e_sm ++;
+}
+
+void eos_reactor_count(void)
+{
+    eos_test.e_reactor ++;
+}
+
+/* All the words of one block are the same, so the torn block is found. */
+static void block_fill(e_block_t *block, uint32_t stamp)
+{
+    for (uint32_t i = 0; i < VALUE_WORDS; i ++)
+    {
+        block->word[i] = stamp;
+    }
+}
+
+void timer_isr_1ms(void)
+{
+    eos_interrupt_enter();
+
+    if (eos_test.isr_func_enable != 0)
+    {
+        eos_test.isr_count ++;
+        block_fill(&block_isr, 0x03000000 | eos_test.isr_count);
+        eos_db_block_write_h(topic_block, &block_isr);
+    }
+
+    eos_interrupt_leave();
+}
+
+void eos_idle_count(void)
+{
+    eos_test.idle_count ++;
+}
+
+/* public function ---------------------------------------------------------- */
+static void task_func_e_give1(void *parameter)
+{
+    e_block_t block;
+    (void)parameter;
+
+    while (1)
+    {
+        eos_test.time = eos_tick_get_ms();
+        eos_test.send_count ++;
+        eos_test.send_give1_count ++;
+        eos_test.send_speed = eos_test.send_count / eos_test.time;
+
+        block_fill(&block, 0x01000000 | eos_test.send_give1_count);
+        eos_db_block_write("Event_Block", &block);
+    }
+}
+
+static void task_func_e_give2(void *parameter)
+{
+    e_block_t block;
+    (void)parameter;
+
+    while (1)
+    {
+        eos_test.time = eos_tick_get_ms();
+        eos_test.send_count ++;
+        eos_test.send_give2_count ++;
+        eos_test.send_speed = eos_test.send_count / eos_test.time;
+
+        block_fill(&block, 0x02000000 | eos_test.send_give2_count);
+        eos_db_block_write_h(topic_block, &block);
+    }
+}
+
+static void task_func_e_value(void *parameter)
+{
+    e_block_t block;
+    (void)parameter;
+
+    eos_test.isr_func_enable = 1;
+
+    while (1)
+    {
+        for (uint32_t n = 0; n < VALUE_READ_BURST; n ++)
+        {
+            eos_db_block_read_h(topic_block, &block);
+            for (uint32_t i = 1; i < VALUE_WORDS; i ++)
+            {
+                if (block.word[i] != block.word[0])
+                {
+                    eos_test.error ++;
+                    break;
+                }
+            }
+            eos_test.read_count ++;
+        }
+
+        eos_task_delay_ms(1);
+    }
+}
+
+#endif
@@ -0,0 +1,186 @@
+#include "test.h"
+#include <stdint.h>
+#include <stddef.h>
+#include "eos.h"
+#include "bsp.h"
+
+#if (TEST_EN_16 != 0)
+
+/* private data structure --------------------------------------------------- */
+typedef struct e_status
+{
+    uint32_t count;                         // Written every millisecond.
+    uint8_t name[188];                      // Never written.
+    uint32_t count_slow;                    // Written every 10 milliseconds.
+    uint32_t count_check;                   // The same as count_slow.
+} e_status_t;
+
+typedef struct eos_test
+{
+    uint32_t error;
+
+    uint32_t write_count;
+    uint32_t e_status;
+    uint32_t e_slow;                        // The events with the slow field.
+
+    uint32_t e_sm;
+    uint32_t e_reactor;
+    uint32_t idle_count;
+} eos_test_t;
+
+typedef struct task_test
+{
+    eos_task_t *task;
+    const char *name;
+    uint8_t prio;
+    void *stack;
+    uint32_t stack_size;
+    void (* func)(void *parameter);
+} task_test_info_t;
+
+static void task_func_high(void *parameter);
+static void task_func_e_value(void *parameter);
+
+/* private data ------------------------------------------------------------- */
+static uint64_t stack_high[64];
+static eos_task_t task_high;
+static uint64_t stack_e_value[64];
+static eos_task_t task_e_value;
+
+eos_test_t eos_test;
+
+static const task_test_info_t task_test_info[] =
+{
+    {
+        &task_high, "TaskHigh", TaskPrio_High,
+        stack_high, sizeof(stack_high),
+        task_func_high
+    },
+    {
+        &task_e_value, "TaskValue", TaskPrio_Value,
+        stack_e_value, sizeof(stack_e_value),
+        task_func_e_value
+    },
+};
+
+/* public function ---------------------------------------------------------- */
+void test_init(void)
+{
+    eos_db_register("Event_Status", sizeof(e_status_t), EOS_DB_ATTRIBUTE_VALUE);
+
+    for (uint32_t i = 0;
+         i < (sizeof(task_test_info) / sizeof(task_test_info_t));
+         i ++)
+    {
+        eos_task_init(task_test_info[i].task,
+                       task_test_info[i].name,
+                       task_test_info[i].func,
+                       EOS_NULL,
+                       task_test_info[i].stack,
+                       task_test_info[i].stack_size,
+                       task_test_info[i].prio);
+        eos_task_startup(task_test_info[i].task);
+    }
+}
+
+void eos_sm_count(void)
+{
+    eos_test.e_sm ++;
+}
+
+void eos_reactor_count(void)
+{
+    eos_test.e_reactor ++;
+}
+
+void timer_isr_1ms(void)
+{
+}
+
+void eos_idle_count(void)
+{
+    eos_test.idle_count ++;
+}
+
+/* private function --------------------------------------------------------- */
+/* Only the changed fields are written, not the whole status. */
+static void task_func_high(void *parameter)
+{
+    uint32_t slow[2];
+    (void)parameter;
+
+    while (1)
+    {
+        eos_test.write_count ++;
+        eos_db_write_range("Event_Status", offsetof(e_status_t, count),
+                           sizeof(uint32_t), &eos_test.write_count);
+        if ((eos_test.write_count % 10) == 0)
+        {
+            slow[0] = eos_test.write_count;
+            slow[1] = eos_test.write_count;
+            eos_db_write_range("Event_Status", offsetof(e_status_t, count_slow),
+                               sizeof(slow), slow);
+        }
+        eos_event_publish("Event_Status");
+
+        eos_task_delay_ms(1);
+    }
+}
+
+/* Only the fields in the dirty mask are read. */
+static void task_func_e_value(void *parameter)
+{
+    eos_event_t e;
+    uint32_t count;
+    uint32_t slow[2];
+    (void)parameter;
+
+    eos_event_sub("Event_Status");
+    uint32_t mask_count =
+        eos_db_range_mask("Event_Status", offsetof(e_status_t, count),
+                          sizeof(uint32_t));
+    uint32_t mask_slow =
+        eos_db_range_mask("Event_Status", offsetof(e_status_t, count_slow),
+                          sizeof(slow));
+
+    while (1)
+    {
+        if (eos_task_wait_event(&e, 10000) == false)
+        {
+            eos_test.error ++;
+            continue;
+        }
+        if (!eos_event_topic(&e, "Event_Status"))
+        {
+            continue;
+        }
+        eos_test.e_status ++;
+
+        /* The regions of the name are never written, except the ones shared
+           with the other fields. */
+        if ((e.value & mask_count) == 0 ||
+            (e.value & ~(mask_count | mask_slow)) != 0)
+        {
+            eos_test.error ++;
+        }
+        eos_db_read_range("Event_Status", offsetof(e_status_t, count),
+                          sizeof(count), &count);
+        if (count == 0)
+        {
+            eos_test.error ++;
+        }
+
+        if ((e.value & mask_slow) != 0)
+        {
+            eos_test.e_slow ++;
+            eos_db_read_range("Event_Status", offsetof(e_status_t, count_slow),
+                              sizeof(slow), slow);
+            if (slow[0] != slow[1] || (slow[0] % 10) != 0)
+            {
+                eos_test.error ++;
+            }
+        }
+    }
+}
+
+#endif
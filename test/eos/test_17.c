@@ -0,0 +1,193 @@
+#include "test.h"
+#include <stdint.h>
+#include "eos.h"
+#include "bsp.h"
+
+#if (TEST_EN_17 != 0)
+
+/* private data structure --------------------------------------------------- */
+typedef struct eos_test
+{
+    uint32_t error;
+
+    uint32_t write_count;
+    uint32_t step_mode;                     // The changes of the mode.
+    uint32_t step_temp;                     // The steps out of the deadband.
+    uint32_t e_mode;
+    uint32_t e_temp;
+    uint32_t suppressed_mode;
+    uint32_t suppressed_temp;
+
+    uint32_t e_sm;
+    uint32_t e_reactor;
+    uint32_t idle_count;
+} eos_test_t;
+
+typedef struct task_test
+{
+    eos_task_t *task;
+    const char *name;
+    uint8_t prio;
+    void *stack;
+    uint32_t stack_size;
+    void (* func)(void *parameter);
+} task_test_info_t;
+
+static void task_func_high(void *parameter);
+static void task_func_e_value(void *parameter);
+
+/* private data ------------------------------------------------------------- */
+static uint64_t stack_high[64];
+static eos_task_t task_high;
+static uint64_t stack_e_value[64];
+static eos_task_t task_e_value;
+
+static uint32_t seed = 1;
+
+eos_test_t eos_test;
+
+static const task_test_info_t task_test_info[] =
+{
+    {
+        &task_high, "TaskHigh", TaskPrio_High,
+        stack_high, sizeof(stack_high),
+        task_func_high
+    },
+    {
+        &task_e_value, "TaskValue", TaskPrio_Value,
+        stack_e_value, sizeof(stack_e_value),
+        task_func_e_value
+    },
+};
+
+/* public function ---------------------------------------------------------- */
+void test_init(void)
+{
+    /* The mode is compared exactly, and the temperature with the deadband. */
+    eos_db_register("Event_Mode", sizeof(uint32_t),
+                    (EOS_DB_ATTRIBUTE_VALUE | EOS_DB_ATTRIBUTE_ON_CHANGE));
+    eos_db_register("Event_Temp", sizeof(float),
+                    (EOS_DB_ATTRIBUTE_VALUE | EOS_DB_ATTRIBUTE_ON_CHANGE));
+    eos_db_deadband_f32("Event_Temp", 0.5f);
+
+    for (uint32_t i = 0;
+         i < (sizeof(task_test_info) / sizeof(task_test_info_t));
+         i ++)
+    {
+        eos_task_init(task_test_info[i].task,
+                       task_test_info[i].name,
+                       task_test_info[i].func,
+                       EOS_NULL,
+                       task_test_info[i].stack,
+                       task_test_info[i].stack_size,
+                       task_test_info[i].prio);
+        eos_task_startup(task_test_info[i].task);
+    }
+}
+
+void eos_sm_count(void)
+{
+    eos_test.e_sm ++;
+}
+
+void eos_reactor_count(void)
+{
+    eos_test.e_reactor ++;
+}
+
+void timer_isr_1ms(void)
+{
+}
+
+void eos_idle_count(void)
+{
+    eos_test.idle_count ++;
+}
+
+/* private function --------------------------------------------------------- */
+static uint32_t test_rand(void)
+{
+    seed = seed * 1103515245 + 12345;
+
+    return (seed >> 16);
+}
+
+/* Write and publish both values every millisecond. The mode changes every
+   100ms, and the temperature steps by 1.0 every 50ms, with the noise of 0.2
+   at most. Only the changes are given to the subscriber. */
+static void task_func_high(void *parameter)
+{
+    uint32_t mode = 0;
+    float temp_base = 20.0f;
+    (void)parameter;
+
+    while (1)
+    {
+        eos_test.write_count ++;
+        if ((eos_test.write_count % 100) == 0)
+        {
+            mode ++;
+            eos_test.step_mode ++;
+        }
+        if ((eos_test.write_count % 50) == 0)
+        {
+            temp_base += 1.0f;
+            eos_test.step_temp ++;
+        }
+        float temp = temp_base + (float)(test_rand() % 21) / 100.0f;
+
+        eos_db_block_write("Event_Mode", &mode);
+        eos_event_publish("Event_Mode");
+        eos_db_block_write("Event_Temp", &temp);
+        eos_event_publish("Event_Temp");
+
+        eos_test.suppressed_mode = eos_db_suppressed("Event_Mode");
+        eos_test.suppressed_temp = eos_db_suppressed("Event_Temp");
+
+        eos_task_delay_ms(1);
+    }
+}
+
+static void task_func_e_value(void *parameter)
+{
+    eos_event_t e;
+    uint32_t mode_last = 0xFFFFFFFF;
+    uint32_t mode;
+    (void)parameter;
+
+    eos_event_sub("Event_Mode");
+    eos_event_sub("Event_Temp");
+
+    while (1)
+    {
+        if (eos_task_wait_event(&e, 10000) == false)
+        {
+            eos_test.error ++;
+            continue;
+        }
+
+        if (eos_event_topic(&e, "Event_Mode"))
+        {
+            eos_test.e_mode ++;
+            eos_db_block_read("Event_Mode", &mode);
+            if (mode == mode_last)
+            {
+                eos_test.error ++;
+            }
+            mode_last = mode;
+        }
+        else if (eos_event_topic(&e, "Event_Temp"))
+        {
+            eos_test.e_temp ++;
+        }
+
+        /* One event for one change at most. */
+        if (eos_test.e_mode > (eos_test.step_mode + 1) ||
+            eos_test.e_temp > (eos_test.step_temp + 1))
+        {
+            eos_test.error ++;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,198 @@
+#include "test.h"
+#include <stdint.h>
+#include "eos.h"
+#include "bsp.h"
+
+#if (TEST_EN_18 != 0)
+
+#if (EOS_USE_DB_PERSIST == 0)
+#error The test 18 needs EOS_USE_DB_PERSIST !
+#endif
+
+/* private define ----------------------------------------------------------- */
+#define FLASH_SECTOR_SIZE                       4096
+#define FLASH_SECTOR_COUNT                      16
+
+/* private data structure --------------------------------------------------- */
+typedef struct e_config
+{
+    uint32_t stamp;
+    uint32_t word[15];                      // The same as the stamp.
+} e_config_t;
+
+typedef struct eos_test
+{
+    uint32_t error;
+
+    uint32_t boot;                          // The boots saved in the flash.
+    uint32_t count_boot;                    // The count saved before booting.
+    uint32_t mount_us;
+    uint32_t write_count;
+    uint32_t write_amp;                     // The flash bytes per value byte, x100.
+    uint32_t save_speed;                    // The value bytes saved per second.
+    uint32_t flash_speed;                   // The flash bytes per second.
+    eos_db_persist_info_t info;
+    flash_stats_t flash;
+
+    uint32_t e_sm;
+    uint32_t e_reactor;
+    uint32_t idle_count;
+} eos_test_t;
+
+typedef struct task_test
+{
+    eos_task_t *task;
+    const char *name;
+    uint8_t prio;
+    void *stack;
+    uint32_t stack_size;
+    void (* func)(void *parameter);
+} task_test_info_t;
+
+static void task_func_high(void *parameter);
+static void task_func_e_value(void *parameter);
+
+/* private data ------------------------------------------------------------- */
+static uint64_t stack_high[64];
+static eos_task_t task_high;
+static uint64_t stack_e_value[64];
+static eos_task_t task_e_value;
+
+eos_test_t eos_test;
+
+static const task_test_info_t task_test_info[] =
+{
+    {
+        &task_high, "TaskHigh", TaskPrio_High,
+        stack_high, sizeof(stack_high),
+        task_func_high
+    },
+    {
+        &task_e_value, "TaskValue", TaskPrio_Value,
+        stack_e_value, sizeof(stack_e_value),
+        task_func_e_value
+    },
+};
+
+/* public function ---------------------------------------------------------- */
+void test_init(void)
+{
+    eos_db_register("Event_Boot", sizeof(uint32_t),
+                    (EOS_DB_ATTRIBUTE_VALUE | EOS_DB_ATTRIBUTE_PERSISTENT));
+    eos_db_register("Event_Count", sizeof(uint32_t),
+                    (EOS_DB_ATTRIBUTE_VALUE | EOS_DB_ATTRIBUTE_PERSISTENT));
+    eos_db_register("Event_Config", sizeof(e_config_t),
+                    (EOS_DB_ATTRIBUTE_VALUE | EOS_DB_ATTRIBUTE_PERSISTENT));
+
+    /* The keys get their values saved in the last run. */
+    const eos_flash_t *flash = flash_sim_open("flash.bin", FLASH_SECTOR_SIZE,
+                                              FLASH_SECTOR_COUNT);
+    uint32_t time_mount = bsp_time_us();
+    eos_db_persist_mount(flash);
+    eos_test.mount_us = bsp_time_us() - time_mount;
+
+    e_config_t config;
+    eos_db_block_read("Event_Boot", &eos_test.boot);
+    eos_db_block_read("Event_Count", &eos_test.count_boot);
+    eos_db_block_read("Event_Config", &config);
+    for (uint32_t i = 0; i < 15; i ++)
+    {
+        if (config.word[i] != config.stamp)
+        {
+            eos_test.error ++;
+        }
+    }
+    eos_test.boot ++;
+    eos_db_block_write("Event_Boot", &eos_test.boot);
+
+    for (uint32_t i = 0;
+         i < (sizeof(task_test_info) / sizeof(task_test_info_t));
+         i ++)
+    {
+        eos_task_init(task_test_info[i].task,
+                       task_test_info[i].name,
+                       task_test_info[i].func,
+                       EOS_NULL,
+                       task_test_info[i].stack,
+                       task_test_info[i].stack_size,
+                       task_test_info[i].prio);
+        eos_task_startup(task_test_info[i].task);
+    }
+}
+
+void eos_sm_count(void)
+{
+    eos_test.e_sm ++;
+}
+
+void eos_reactor_count(void)
+{
+    eos_test.e_reactor ++;
+}
+
+void timer_isr_1ms(void)
+{
+}
+
+void eos_idle_count(void)
+{
+    eos_test.idle_count ++;
+}
+
+/* private function --------------------------------------------------------- */
+/* The count goes on from the saved one, and is written every millisecond, but
+   only saved in batches. The configuration is written every 100ms. */
+static void task_func_high(void *parameter)
+{
+    uint32_t count = eos_test.count_boot;
+    e_config_t config;
+    (void)parameter;
+
+    while (1)
+    {
+        count ++;
+        eos_test.write_count ++;
+        eos_db_block_write("Event_Count", &count);
+        if ((eos_test.write_count % 100) == 0)
+        {
+            config.stamp = eos_test.write_count;
+            for (uint32_t i = 0; i < 15; i ++)
+            {
+                config.word[i] = config.stamp;
+            }
+            eos_db_block_write("Event_Config", &config);
+        }
+
+        eos_task_delay_ms(1);
+    }
+}
+
+/* Flush the keys every second, and measure the saving. */
+static void task_func_e_value(void *parameter)
+{
+    (void)parameter;
+
+    while (1)
+    {
+        eos_task_delay_ms(1000);
+        eos_db_persist_flush();
+
+        eos_db_persist_info(&eos_test.info);
+        flash_sim_stats(&eos_test.flash);
+        if (eos_test.flash.error != 0)
+        {
+            eos_test.error ++;
+        }
+
+        uint32_t time = eos_tick_get_ms() / 1000;
+        if (eos_test.info.bytes_value != 0 && time != 0)
+        {
+            eos_test.write_amp = (uint32_t)(((uint64_t)eos_test.info.bytes_flash *
+                                             100) / eos_test.info.bytes_value);
+            eos_test.save_speed = eos_test.info.bytes_value / time;
+            eos_test.flash_speed = eos_test.info.bytes_flash / time;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,247 @@
+#include "test.h"
+#include <stdint.h>
+#include "eos.h"
+#include "bsp.h"
+
+#if (TEST_EN_19 != 0)
+
+/* private define ----------------------------------------------------------- */
+#define TABLE_WORDS                             256         // 1024 bytes
+#define TABLE_READ_BURST                        100
+#define TABLE_HOLD_MS                           15
+
+/* private data structure --------------------------------------------------- */
+typedef struct e_table
+{
+    uint32_t word[TABLE_WORDS];
+} e_table_t;
+
+typedef struct eos_test
+{
+    uint32_t error;                             // The torn or changed tables.
+
+    uint32_t write_count;
+    uint32_t write_wait;                        // The writes waiting a tick.
+    uint32_t read_count;
+    uint32_t hold_count;                        // The tables held for 15ms.
+    uint32_t isr_read_count;
+    uint32_t unsub_count;                       // The unsubscribing times.
+
+    uint32_t e_sm;
+    uint32_t e_reactor;
+    uint32_t isr_count;
+    uint32_t idle_count;
+} eos_test_t;
+
+typedef struct task_test
+{
+    eos_task_t *task;
+    const char *name;
+    uint8_t prio;
+    void *stack;
+    uint32_t stack_size;
+    void (* func)(void *parameter);
+} task_test_info_t;
+
+static void task_func_high(void *parameter);
+static void task_func_e_value(void *parameter);
+static void task_func_hold(void *parameter);
+
+/* private data ------------------------------------------------------------- */
+static uint64_t stack_high[64];
+static eos_task_t task_high;
+static uint64_t stack_e_value[64];
+static eos_task_t task_e_value;
+static uint64_t stack_hold[64];
+static eos_task_t task_hold;
+
+static uint8_t isr_func_enable = 0;
+
+eos_test_t eos_test;
+
+static const task_test_info_t task_test_info[] =
+{
+    {
+        &task_high, "TaskHigh", TaskPrio_High,
+        stack_high, sizeof(stack_high),
+        task_func_high
+    },
+    {
+        &task_e_value, "TaskValue", TaskPrio_Value,
+        stack_e_value, sizeof(stack_e_value),
+        task_func_e_value
+    },
+    {
+        &task_hold, "TaskHold", TaskPrio_Middle,
+        stack_hold, sizeof(stack_hold),
+        task_func_hold
+    },
+};
+
+/* public function ---------------------------------------------------------- */
+void test_init(void)
+{
+    /* The table is read in place, and never copied by the readers. */
+    eos_db_register("Event_Table", sizeof(e_table_t),
+                    (EOS_DB_ATTRIBUTE_VALUE | EOS_DB_ATTRIBUTE_BUFFERED));
+
+    for (uint32_t i = 0;
+         i < (sizeof(task_test_info) / sizeof(task_test_info_t));
+         i ++)
+    {
+        eos_task_init(task_test_info[i].task,
+                       task_test_info[i].name,
+                       task_test_info[i].func,
+                       EOS_NULL,
+                       task_test_info[i].stack,
+                       task_test_info[i].stack_size,
+                       task_test_info[i].prio);
+        eos_task_startup(task_test_info[i].task);
+    }
+
+    timer_init(1);
+}
+
+void eos_sm_count(void)
+{
+    eos_test.e_sm ++;
+}
+
+void eos_reactor_count(void)
+{
+    eos_test.e_reactor ++;
+}
+
+/* All the words of one table are the same, so the torn table is found. */
+static bool table_check(const e_table_t *table)
+{
+    for (uint32_t i = 1; i < TABLE_WORDS; i ++)
+    {
+        if (table->word[i] != table->word[0])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/* The interrupt handler only looks at both ends of the table. */
+void timer_isr_1ms(void)
+{
+    eos_interrupt_enter();
+
+    if (isr_func_enable != 0)
+    {
+        eos_test.isr_count ++;
+        const e_table_t *table = eos_db_value_acquire("Event_Table");
+        if (table->word[0] != table->word[TABLE_WORDS - 1])
+        {
+            eos_test.error ++;
+        }
+        eos_db_value_release("Event_Table", table);
+        eos_test.isr_read_count ++;
+    }
+
+    eos_interrupt_leave();
+}
+
+void eos_idle_count(void)
+{
+    eos_test.idle_count ++;
+}
+
+/* private function --------------------------------------------------------- */
+/* Fill a spare version of the table every millisecond, and publish it. */
+static void task_func_high(void *parameter)
+{
+    (void)parameter;
+
+    isr_func_enable = 1;
+
+    while (1)
+    {
+        eos_u32_t time = eos_tick_get_ms();
+        e_table_t *table = eos_db_value_reserve("Event_Table");
+        if (eos_tick_get_ms() != time)
+        {
+            eos_test.write_wait ++;
+        }
+
+        eos_test.write_count ++;
+        for (uint32_t i = 0; i < TABLE_WORDS; i ++)
+        {
+            table->word[i] = eos_test.write_count;
+        }
+        eos_db_value_commit("Event_Table", table);
+        eos_event_publish("Event_Table");
+
+        eos_task_delay_ms(1);
+    }
+}
+
+/* Read the table in place many times, and with a copy sometimes. The table
+   is unsubscribed and subscribed again every time, which never touches its
+   versions, and the next publishing still wakes the task. */
+static void task_func_e_value(void *parameter)
+{
+    e_table_t table;
+    (void)parameter;
+
+    eos_event_sub("Event_Table");
+
+    while (1)
+    {
+        eos_event_unsub("Event_Table");
+        eos_test.unsub_count ++;
+        eos_event_sub("Event_Table");
+
+        for (uint32_t n = 0; n < TABLE_READ_BURST; n ++)
+        {
+            const e_table_t *current = eos_db_value_acquire("Event_Table");
+            if (!table_check(current))
+            {
+                eos_test.error ++;
+            }
+            eos_db_value_release("Event_Table", current);
+            eos_test.read_count ++;
+        }
+
+        eos_db_block_read("Event_Table", &table);
+        if (!table_check(&table))
+        {
+            eos_test.error ++;
+        }
+
+        /* The table is published every millisecond. */
+        eos_event_t e;
+        if (eos_task_wait_event(&e, 100) == false)
+        {
+            eos_test.error ++;
+        }
+    }
+}
+
+/* Hold one version for many writes. It is never written meanwhile, and the
+   writer goes on with the other spare version. */
+static void task_func_hold(void *parameter)
+{
+    (void)parameter;
+
+    while (1)
+    {
+        const e_table_t *table = eos_db_value_acquire("Event_Table");
+        uint32_t stamp = table->word[0];
+        eos_task_delay_ms(TABLE_HOLD_MS);
+        if (table->word[0] != stamp || !table_check(table))
+        {
+            eos_test.error ++;
+        }
+        eos_db_value_release("Event_Table", table);
+        eos_test.hold_count ++;
+
+        eos_task_delay_ms(TABLE_HOLD_MS);
+    }
+}
+
+#endif
@@ -8,16 +8,34 @@ eos_led_sm.c ^
 test.c ^
 test_01_0.c ^
 test_01_1.c ^
+test_01_2.c ^
+test_01_3.c ^
 test_02_0.c ^
 test_02_1.c ^
 test_02_2.c ^
+test_02_3.c ^
+test_02_4.c ^
 test_03.c ^
 test_04.c ^
 test_05_0.c ^
 test_05_1.c ^
+test_05_2.c ^
 test_06.c ^
+test_06_1.c ^
 test_07.c ^
+test_08.c ^
 test_09.c ^
+test_10.c ^
+test_11.c ^
+test_12.c ^
+test_13.c ^
+test_14.c ^
+test_15.c ^
+test_16.c ^
+test_17.c ^
+test_18.c ^
+test_19.c ^
+flash_win32.c ^
 ..\eventos\eos.c ^
 ..\eventos\eos_kernel.c ^
 ..\libcpu\win32\cpu_port.c ^
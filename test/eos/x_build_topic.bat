@@ -0,0 +1,24 @@
+md build
+
+python ..\tools\eos_topic_gen.py eos_topic.txt build\eos_topic_table.h
+
+gcc -std=c99 -g ^
+-DEOS_USE_TOPIC_TABLE=1 ^
+-DTEST_MODE=1 ^
+main_win32.c ^
+bsp_win32.c ^
+hook.c ^
+eos_led_sm.c ^
+test.c ^
+test_02_0.c ^
+..\eventos\eos.c ^
+..\eventos\eos_kernel.c ^
+..\libcpu\win32\cpu_port.c ^
+-I ..\eventos ^
+-I build ^
+-I . ^
+-I ..\libcpu\win32 ^
+-o build\e_topic ^
+-l Winmm
+
+build\e_topic
@@ -0,0 +1,151 @@
+# Filename: eos_topic_gen.py
+
+# Generate the topic table of EventOS from a manifest of the keys known in the
+# building time. The table is a minimal perfect hash table, so the known keys
+# are registered without any hashing in eos_init(), and found in one probe.
+# The keys not in the manifest are still registered in the running time.
+#
+# Usage:
+#   python eos_topic_gen.py eos_topic.txt [eos_topic_table.h]
+#
+# The manifest has one key in every line, and the lines starting with '#' are
+# comments. The kind of the key is one of task, topic and db.
+#   task    TaskValue
+#   topic   Event_One
+#   db      Event_Value
+#
+# Put the generated header in the include path, and set EOS_USE_TOPIC_TABLE
+# to 1 in eos_config.h.
+
+import sys
+
+# The object types in eos.c, and the type char in the time33 hash.
+obj_type = { 'task': (0, 'A'), 'topic': (1, 'E'), 'db': (1, 'E') }
+
+
+def hash_time33(ch_type, key):
+    hash = 5381
+    hash = (hash + (hash << 5) + ord(ch_type)) & 0xffffffff
+    for ch in key.encode('utf-8'):
+        hash = (hash + (hash << 5) + ch) & 0xffffffff
+
+    return hash & 0x7fffffff
+
+
+# The same as eos_topic_table_slot_() in eos.c.
+def table_slot(hash, seed, size):
+    x = (hash + seed * 0x9e3779b1) & 0xffffffff
+    x ^= (x >> 15)
+    x = (x * 0x85ebca6b) & 0xffffffff
+    x ^= (x >> 13)
+
+    return x % size
+
+
+def read_manifest(path):
+    keys = []
+    f = open(path, mode = 'r', encoding = 'utf-8')
+    for number, line in enumerate(f, 1):
+        line = line.strip()
+        if line == '' or line.startswith('#'):
+            continue
+        items = line.split()
+        if len(items) != 2 or items[0] not in obj_type:
+            sys.exit('%s:%d: bad line "%s"' % (path, number, line))
+        type, ch_type = obj_type[items[0]]
+        keys.append((items[1], type, hash_time33(ch_type, items[1])))
+    f.close()
+
+    # The hashed lookup only compares the hash value, so the hash of every key
+    # must be different in one object type.
+    known = {}
+    for key, type, hash in keys:
+        if (type, hash) in known:
+            if known[(type, hash)] == key:
+                sys.exit('The key %s is declared twice.' % key)
+            sys.exit('The keys %s and %s have the same hash value, rename '
+                     'one of them.' % (known[(type, hash)], key))
+        known[(type, hash)] = key
+
+    return keys
+
+
+# Hash and displace. The keys are put into buckets, and from the largest bucket
+# on, the seed making all the keys of the bucket into free slots is searched.
+def build_table(keys):
+    size = len(keys)
+    seed_size = (size + 3) // 4
+    while True:
+        buckets = [[] for i in range(seed_size)]
+        for index, (key, type, hash) in enumerate(keys):
+            buckets[hash % seed_size].append(index)
+
+        seeds = [0] * seed_size
+        table = [None] * size
+        done = True
+        for b in sorted(range(seed_size), key = lambda b: -len(buckets[b])):
+            if len(buckets[b]) == 0:
+                break
+            for seed in range(65536):
+                slots = [table_slot(keys[i][2], seed, size) for i in buckets[b]]
+                if len(set(slots)) == len(slots) and \
+                   all(table[slot] is None for slot in slots):
+                    break
+            else:
+                done = False
+                break
+            seeds[b] = seed
+            for i, slot in zip(buckets[b], slots):
+                table[slot] = keys[i]
+        if done:
+            return seeds, table
+        seed_size += 1
+
+
+def write_table(path, manifest, seeds, table):
+    lines = []
+    lines.append('/* Generated by tools/eos_topic_gen.py from %s, do not edit it. */'
+                 % manifest)
+    lines.append('#ifndef EOS_TOPIC_TABLE_H__')
+    lines.append('#define EOS_TOPIC_TABLE_H__')
+    lines.append('')
+    lines.append('#define EOS_TOPIC_TABLE_SIZE                    %d' % len(table))
+    lines.append('#define EOS_TOPIC_SEED_SIZE                     %d' % len(seeds))
+    lines.append('')
+    lines.append('static const eos_u16_t eos_topic_seed[EOS_TOPIC_SEED_SIZE] =')
+    lines.append('{')
+    for i in range(0, len(seeds), 8):
+        lines.append('    ' + ', '.join('%d' % s for s in seeds[i:i + 8]) + ',')
+    lines.append('};')
+    lines.append('')
+    lines.append('static const eos_topic_key_t eos_topic_table[EOS_TOPIC_TABLE_SIZE] =')
+    lines.append('{')
+    for key, type, hash in table:
+        length = len(key.encode('utf-8'))
+        lines.append('    { "%s", 0x%08xU, %d, %d },' % (key, hash, length, type))
+    lines.append('};')
+    lines.append('')
+    lines.append('#endif')
+    lines.append('')
+
+    f = open(path, mode = 'w', encoding = 'utf-8', newline = '\n')
+    f.write('\n'.join(lines))
+    f.close()
+
+
+def execute():
+    if len(sys.argv) < 2:
+        sys.exit('Usage: python eos_topic_gen.py eos_topic.txt [eos_topic_table.h]')
+    manifest = sys.argv[1]
+    output = sys.argv[2] if len(sys.argv) > 2 else 'eos_topic_table.h'
+
+    keys = read_manifest(manifest)
+    if len(keys) == 0:
+        sys.exit('No key is declared in %s.' % manifest)
+    seeds, table = build_table(keys)
+    write_table(output, manifest, seeds, table)
+    print('%d keys, %d seeds, written to %s.' % (len(table), len(seeds), output))
+
+
+if __name__ == '__main__':
+    execute()